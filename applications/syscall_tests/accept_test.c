@@ -0,0 +1,94 @@
+// The Mordax Microkernel OS Service Accept Test Programme
+// (c) Kristian Klomsten Skordal <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#include <stdint.h>
+
+#include <mordax.h>
+#include <mordax-ipc.h>
+#include <mordax/errno.h>
+
+#define NUM_CLIENTS	3
+#define BACKLOG		2
+
+static uint32_t test_thread_stacks[NUM_CLIENTS][256];
+
+// Exits with 1 if the connection was refused and 0 if it was accepted:
+void test_thread(void)
+{
+	mordax_resource_t socket = mordax_service_connect("/accept-test", 12);
+	if(socket == -ECONNREFUSED)
+		mordax_thread_exit(1);
+	else if(socket < 0)
+	{
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Could not connect to the service!");
+		mordax_thread_exit(-1);
+	}
+
+	mordax_socket_send(socket, "C", 1);
+	mordax_resource_destroy(socket);
+	mordax_thread_exit(0);
+}
+
+int main(void)
+{
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Mordax Service Accept Test Application");
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Creating service /accept-test...");
+	mordax_resource_t service = mordax_service_create("/accept-test", 12);
+	if(mordax_service_set_backlog(service, MORDAX_SERVICE_MAX_BACKLOG + 1) != -EINVAL)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Backlog larger than the maximum was accepted!");
+	mordax_service_set_backlog(service, BACKLOG);
+
+	mordax_resource_t waitset = mordax_waitset_create();
+	mordax_waitset_add(waitset, service);
+
+	// Fill the backlog, one client at a time. Each client that is put in the
+	// backlog makes the service ready:
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Starting clients...");
+	tid_t clients[NUM_CLIENTS];
+	for(int i = 0; i < BACKLOG; ++i)
+	{
+		struct mordax_waitset_event event;
+		clients[i] = mordax_thread_create(test_thread, test_thread_stacks[i] + 252);
+		if(mordax_waitset_wait(waitset, &event, 1) != 1 || event.resource != service)
+			mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect event for connecting client!");
+	}
+
+	// The backlog is full, so the remaining clients are refused and exit:
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Starting clients that do not fit in the backlog...");
+	for(int i = BACKLOG; i < NUM_CLIENTS; ++i)
+	{
+		clients[i] = mordax_thread_create(test_thread, test_thread_stacks[i] + 252);
+		if(mordax_thread_join(clients[i]) != 1)
+			mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Client was not refused!");
+	}
+
+	// All waiting clients are accepted by one call:
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Accepting waiting clients...");
+	mordax_resource_t sockets[NUM_CLIENTS + 1];
+	int accepted = mordax_service_accept(service, sockets, NUM_CLIENTS + 1);
+	if(accepted != BACKLOG)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect number of accepted clients!");
+
+	for(int i = 0; i < accepted; ++i)
+	{
+		char buffer;
+		if(mordax_socket_receive(sockets[i], &buffer, 1) != 1 || buffer != 'C')
+			mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect message from client!");
+		mordax_resource_destroy(sockets[i]);
+	}
+
+	for(int i = 0; i < BACKLOG; ++i)
+	{
+		if(mordax_thread_join(clients[i]) != 0)
+			mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Client was not accepted!");
+	}
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Destroying resources...");
+	mordax_resource_destroy(waitset);
+	mordax_resource_destroy(service);
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Finished.");
+	return 0;
+}
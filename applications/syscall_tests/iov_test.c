@@ -0,0 +1,104 @@
+// The Mordax Microkernel OS Vectored IPC Test Programme
+// (c) Kristian Klomsten Skordal <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#include <stdint.h>
+
+#include <mordax.h>
+#include <mordax-ipc.h>
+#include <mordax/errno.h>
+
+static uint32_t test_thread_stack[256];
+
+static const char expected_message[] = "Hello, vectored world";
+#define MESSAGE_LENGTH	(sizeof(expected_message) - 1)
+
+void test_thread(void)
+{
+	mordax_resource_t socket = mordax_service_connect("/iov-test", 9);
+	if(socket < 0)
+	{
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Could not connect to the service!");
+		mordax_thread_exit(1);
+	}
+
+	char hello[] = "Hello, ", vectored[] = "vectored ", world[] = "world";
+	struct mordax_iovec iov[MORDAX_SOCKET_MAX_IOV + 1] = {
+		{ hello, sizeof(hello) - 1 },
+		{ vectored, sizeof(vectored) - 1 },
+		{ 0, 0 },	// Empty segments are skipped.
+		{ world, sizeof(world) - 1 },
+	};
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Sending segmented messages...");
+	if(mordax_socket_sendv(socket, iov, 4, 0) != MESSAGE_LENGTH)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Could not send first message!");
+
+	// The second message is truncated by the receiver. A sender that blocked
+	// until the message was received gets the number of bytes delivered:
+	if(mordax_socket_sendv(socket, iov, 4, 0) <= 0)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Could not send second message!");
+	if(mordax_socket_sendv(socket, iov, MORDAX_SOCKET_MAX_IOV + 1, 0) != -EINVAL)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Message with too many segments was sent!");
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Closing socket and exiting client thread...");
+	mordax_resource_destroy(socket);
+	mordax_thread_exit(0);
+}
+
+int main(void)
+{
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Mordax Vectored IPC Test Application");
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Creating service /iov-test...");
+	mordax_resource_t service = mordax_service_create("/iov-test", 9);
+
+	// Spawn client thread:
+	tid_t client = mordax_thread_create(test_thread, test_thread_stack + 252);
+	mordax_resource_t socket = mordax_service_listen(service);
+
+	// Receive the first message into segments split at other places than
+	// the segments it was sent from:
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Receiving message into several segments...");
+	char buffer[MESSAGE_LENGTH + 8];
+	struct mordax_iovec iov[3] = {
+		{ buffer, 4 },
+		{ buffer + 4, 10 },
+		{ buffer + 14, sizeof(buffer) - 14 },
+	};
+	if(mordax_socket_receivev(socket, iov, 3, 0) != MESSAGE_LENGTH)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect message length!");
+	for(unsigned int i = 0; i < MESSAGE_LENGTH; ++i)
+	{
+		if(buffer[i] != expected_message[i])
+		{
+			mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect message received!");
+			break;
+		}
+	}
+
+	// A message longer than the segments is truncated:
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Receiving message into too short segments...");
+	iov[0].length = 5;
+	iov[1].base = buffer + 5;
+	iov[1].length = 5;
+	if(mordax_socket_receivev(socket, iov, 2, 0) != 10)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect truncated message length!");
+	for(unsigned int i = 0; i < 10; ++i)
+	{
+		if(buffer[i] != expected_message[i])
+		{
+			mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect truncated message received!");
+			break;
+		}
+	}
+
+	mordax_thread_join(client);
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Destroying resources...");
+	mordax_resource_destroy(socket);
+	mordax_resource_destroy(service);
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Finished.");
+	return 0;
+}
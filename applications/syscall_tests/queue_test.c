@@ -0,0 +1,117 @@
+// The Mordax Microkernel OS Socket Queue Test Programme
+// (c) Kristian Klomsten Skordal <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <mordax.h>
+#include <mordax-ipc.h>
+#include <mordax/errno.h>
+
+static uint32_t test_thread_stack[256];
+
+// Checks whether a thread in this process is blocking:
+static bool thread_is_blocking(tid_t tid)
+{
+	struct mordax_thread_statistics threads[32];
+	int count = mordax_thread_statistics(threads, 32);
+
+	for(int i = 0; i < count && i < 32; ++i)
+	{
+		if(threads[i].pid == mordax_info_page()->pid && threads[i].tid == tid)
+			return threads[i].state == MORDAX_THREAD_STATE_BLOCKING;
+	}
+
+	return false;
+}
+
+void test_thread(void)
+{
+	char start_buffer[2];
+
+	// Fill the queue of the first connection without blocking:
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Filling the message queue...");
+	mordax_resource_t socket = mordax_service_connect("/queue-test", 11);
+	mordax_socket_receive(socket, start_buffer, 2);
+
+	struct mordax_iovec message = { "A", 1 };
+	if(mordax_socket_sendv(socket, &message, 1, MORDAX_SOCKET_NONBLOCK) != 1)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** First message was not queued!");
+	message.base = "B";
+	if(mordax_socket_sendv(socket, &message, 1, MORDAX_SOCKET_NONBLOCK) != 1)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Second message was not queued!");
+	message.base = "X";
+	if(mordax_socket_sendv(socket, &message, 1, MORDAX_SOCKET_NONBLOCK) != -EWOULDBLOCK)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Message was sent to a full queue!");
+	mordax_resource_destroy(socket);
+
+	// Send more messages than fit in the queue of the second connection,
+	// blocking until the server makes room for them:
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Sending messages to a short queue...");
+	socket = mordax_service_connect("/queue-test", 11);
+	mordax_socket_receive(socket, start_buffer, 2);
+	mordax_socket_send(socket, "1", 1);
+	mordax_socket_send(socket, "2", 1);
+	mordax_socket_send(socket, "3", 1);
+	mordax_resource_destroy(socket);
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Exiting client thread...");
+	mordax_thread_exit(0);
+}
+
+int main(void)
+{
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Mordax Socket Queue Test Application");
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Creating service /queue-test...");
+	mordax_resource_t service = mordax_service_create("/queue-test", 11);
+
+	// Spawn client thread:
+	tid_t client = mordax_thread_create(test_thread, test_thread_stack + 252);
+
+	mordax_resource_t first = mordax_service_listen(service);
+	if(mordax_socket_set_queue_depth(first, MORDAX_SOCKET_MAX_QUEUE_DEPTH + 1) != -EINVAL)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Queue depth larger than the maximum was accepted!");
+	mordax_socket_set_queue_depth(first, 2);
+	mordax_socket_send(first, "GO", 2);
+
+	// The client only connects again when it has filled the first queue and
+	// closed the socket. The queued messages can still be received:
+	mordax_resource_t second = mordax_service_listen(service);
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Receiving queued messages from a closed socket...");
+	char buffer[2];
+	if(mordax_socket_receive(first, buffer, 1) != 1 || buffer[0] != 'A')
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect first queued message!");
+	if(mordax_socket_receive(first, buffer, 1) != 1 || buffer[0] != 'B')
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect second queued message!");
+
+	struct mordax_iovec iov = { buffer, 1 };
+	if(mordax_socket_receivev(first, &iov, 1, MORDAX_SOCKET_NONBLOCK) != -ENOTCONN)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Message was received from an empty closed socket!");
+	mordax_resource_destroy(first);
+
+	// Let the client fill the queue of the second connection, and do not
+	// receive anything until it blocks on the full queue:
+	mordax_socket_set_queue_depth(second, 1);
+	mordax_socket_send(second, "GO", 2);
+	while(!thread_is_blocking(client))
+		mordax_thread_yield();
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Receiving messages from a blocking sender...");
+	if(mordax_socket_receive(second, buffer, 1) != 1 || buffer[0] != '1')
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect first message!");
+	if(mordax_socket_receive(second, buffer, 1) != 1 || buffer[0] != '2')
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect second message!");
+	if(mordax_socket_receive(second, buffer, 1) != 1 || buffer[0] != '3')
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect third message!");
+
+	mordax_thread_join(client);
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Destroying resources...");
+	mordax_resource_destroy(second);
+	mordax_resource_destroy(service);
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Finished.");
+	return 0;
+}
@@ -0,0 +1,90 @@
+// The Mordax Microkernel OS Wait Set Test Programme
+// (c) Kristian Klomsten Skordal <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#include <stdint.h>
+
+#include <mordax.h>
+#include <mordax-ipc.h>
+#include <mordax/errno.h>
+
+static uint32_t test_thread_stack[256];
+
+void test_thread(void)
+{
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Connecting to /waitset-test...");
+	mordax_resource_t socket = mordax_service_connect("/waitset-test", 13);
+	if(socket < 0)
+	{
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Could not connect to the service!");
+		mordax_thread_exit(1);
+	}
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Sending test message...");
+	mordax_socket_send(socket, "PING", 4);
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Closing socket and exiting client thread...");
+	mordax_resource_destroy(socket);
+	mordax_thread_exit(0);
+}
+
+int main(void)
+{
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Mordax Wait Set Test Application");
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Creating service and wait sets...");
+	mordax_resource_t service = mordax_service_create("/waitset-test", 13);
+	mordax_resource_t waitset = mordax_waitset_create();
+	mordax_resource_t other_waitset = mordax_waitset_create();
+	mordax_waitset_add(waitset, service);
+
+	// A resource can only be part of one wait set at a time:
+	if(mordax_waitset_add(other_waitset, service) != -EBUSY)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Service was added to two wait sets!");
+	if(mordax_waitset_remove(other_waitset, service) != -ENOENT)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Service was removed from a wait set it is not part of!");
+
+	// Spawn client thread:
+	tid_t client = mordax_thread_create(test_thread, test_thread_stack + 252);
+
+	// A connecting client makes the service ready:
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Waiting for a connecting client...");
+	struct mordax_waitset_event event;
+	if(mordax_waitset_wait(waitset, &event, 1) != 1 || event.resource != service
+		|| (event.events & MORDAX_WAITSET_READY) == 0)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect event for connecting client!");
+
+	mordax_resource_t socket = mordax_service_listen(service);
+	mordax_waitset_remove(waitset, service);
+	mordax_waitset_add(waitset, socket);
+
+	// A message sent by the client makes the socket ready:
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Waiting for a message...");
+	if(mordax_waitset_wait(waitset, &event, 1) != 1 || event.resource != socket
+		|| (event.events & MORDAX_WAITSET_READY) == 0)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect event for message!");
+
+	char test_buffer[4];
+	mordax_socket_receive(socket, test_buffer, 4);
+	if(test_buffer[0] == 'P' && test_buffer[1] == 'I' && test_buffer[2] == 'N' && test_buffer[3] == 'G')
+		mordax_system(MORDAX_SYSTEM_DEBUG, "Test message is correct");
+	else
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect test message received!");
+
+	// Closing the other end of the socket is reported as a hangup:
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Waiting for the client to close its socket...");
+	if(mordax_waitset_wait(waitset, &event, 1) != 1 || event.resource != socket
+		|| (event.events & MORDAX_WAITSET_HANGUP) == 0)
+		mordax_system(MORDAX_SYSTEM_DEBUG, "***ERROR*** Incorrect event for hangup!");
+
+	mordax_thread_join(client);
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Destroying resources...");
+	mordax_resource_destroy(socket);
+	mordax_resource_destroy(other_waitset);
+	mordax_resource_destroy(waitset);
+	mordax_resource_destroy(service);
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Finished.");
+	return 0;
+}
@@ -0,0 +1,133 @@
+// The Mordax Microkernel OS Thread Monitor
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#include <stdint.h>
+#include <mordax.h>
+
+// Maximum number of threads to display:
+#define MAX_THREADS	64
+
+// Time between each update of the display, in microseconds:
+#define UPDATE_INTERVAL	1000000
+
+// Length of a line of output:
+#define LINE_LENGTH	80
+
+static struct mordax_thread_statistics samples[2][MAX_THREADS];
+
+// Appends a string to a line, padded with spaces to the specified width:
+static char * append_string(char * line, const char * string, int width)
+{
+	int length = 0;
+	while(string[length] != 0)
+		++length;
+
+	for(int i = length; i < width; ++i)
+		*line++ = ' ';
+	for(int i = 0; i < length; ++i)
+		*line++ = string[i];
+	return line;
+}
+
+// Appends a number to a line, right-aligned in a field of the specified width.
+// If decimal is set, the last digit is printed after a decimal point:
+static char * append_number(char * line, uint64_t number, int width, bool decimal)
+{
+	char buffer[24];
+	int i = sizeof(buffer) - 1;
+
+	buffer[i] = 0;
+	do {
+		buffer[--i] = '0' + number % 10;
+		number /= 10;
+
+		if(decimal && i == sizeof(buffer) - 2)
+		{
+			buffer[--i] = '.';
+			if(number == 0)
+				buffer[--i] = '0';
+		}
+	} while(number != 0);
+
+	return append_string(line, buffer + i, width);
+}
+
+// Finds the previous sample for a thread:
+static const struct mordax_thread_statistics * find_sample(const struct mordax_thread_statistics * list,
+	int length, const struct mordax_thread_statistics * thread)
+{
+	for(int i = 0; i < length; ++i)
+	{
+		if(list[i].pid == thread->pid && list[i].tid == thread->tid)
+			return &list[i];
+	}
+
+	return 0;
+}
+
+// Prints the statistics for all threads, with CPU usage calculated since the previous sample:
+static void print_statistics(const struct mordax_thread_statistics * current, int current_length,
+	const struct mordax_thread_statistics * previous, int previous_length)
+{
+	static const char state_names[] = "RQB";
+	char line[LINE_LENGTH];
+
+	// Calculate the total number of cycles used by all threads since the last sample:
+	uint64_t total_cycles = 0;
+	for(int i = 0; i < current_length; ++i)
+	{
+		const struct mordax_thread_statistics * last = find_sample(previous, previous_length, &current[i]);
+		total_cycles += current[i].runtime - (last != 0 ? last->runtime : 0);
+	}
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "  PID   TID CPU S   %CPU   RUN(Mc)  WAIT(Mc)      VCSW      ICSW");
+	for(int i = 0; i < current_length; ++i)
+	{
+		const struct mordax_thread_statistics * last = find_sample(previous, previous_length, &current[i]);
+		uint64_t cycles = current[i].runtime - (last != 0 ? last->runtime : 0);
+		char state[2] = { current[i].state < sizeof(state_names) - 1 ? state_names[current[i].state] : '?', 0 };
+		char * end = line;
+
+		end = append_number(end, current[i].pid, 5, false);
+		end = append_number(end, current[i].tid, 6, false);
+		end = append_number(end, current[i].cpu, 4, false);
+		end = append_string(end, state, 2);
+		end = append_number(end, total_cycles != 0 ? cycles * 1000 / total_cycles : 0, 7, true);
+		end = append_number(end, current[i].runtime >> 20, 10, false);
+		end = append_number(end, current[i].wait_time >> 20, 10, false);
+		end = append_number(end, current[i].voluntary_switches, 10, false);
+		end = append_number(end, current[i].involuntary_switches, 10, false);
+		*end = 0;
+
+		mordax_system(MORDAX_SYSTEM_DEBUG, line);
+	}
+}
+
+int main(void)
+{
+	int previous = 0, lengths[2] = { 0, 0 };
+
+	mordax_system(MORDAX_SYSTEM_DEBUG, "Mordax Thread Monitor");
+	while(true)
+	{
+		int current = !previous;
+		int threads = mordax_thread_statistics(samples[current], MAX_THREADS);
+		if(threads < 0)
+		{
+			mordax_system(MORDAX_SYSTEM_DEBUG, "Error: could not get thread statistics!");
+			return 1;
+		}
+
+		lengths[current] = threads < MAX_THREADS ? threads : MAX_THREADS;
+		print_statistics(samples[current], lengths[current], samples[previous], lengths[previous]);
+		if(threads > MAX_THREADS)
+			mordax_system(MORDAX_SYSTEM_DEBUG, "Note: some threads are not shown");
+
+		previous = current;
+		mordax_thread_sleep(UPDATE_INTERVAL);
+	}
+
+	return 0;
+}
+
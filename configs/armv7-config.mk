@@ -20,3 +20,7 @@ export TARGET_ASFLAGS  += -mno-unaligned-access -Wall -O2
 export TARGET_CFLAGS   += -mno-unaligned-access -std=gnu11 -Wall -O2 -fomit-frame-pointer
 export TARGET_LDFLAGS  +=  -nostartfiles
 
+# Kernel log level, messages less important than this are not compiled into
+# the kernel: 0 = errors, 1 = warnings, 2 = information, 3 = debugging:
+export KERNEL_LOG_LEVEL ?= 2
+
@@ -6,28 +6,37 @@
 #include "context.h"
 #include "debug.h"
 #include "kernel.h"
+#include "smp.h"
+#include "trace.h"
 
 bool abort_handler(struct thread_context * context)
 {
 	struct abort_details details;
 	abort_get_details(&details, context);
 
+	// Kernel code runs with the kernel lock held already:
+	if(details.mode == ABORT_USER)
+		spinlock_lock(&kernel_lock);
+	trace_event(MORDAX_TRACE_PAGE_FAULT, details.type == ABORT_WRITE, (uint32_t) details.address);
+
 	if(details.mode == ABORT_KERNEL)
 	{
-		debug_printf("\nINVALID MEMORY ACCESS IN KERNEL MODE\n");
-		debug_printf("Cannot %s address %x\n",
+		log_error("\nINVALID MEMORY ACCESS IN KERNEL MODE\n");
+		log_error("Cannot %s address %x\n",
 			details.type == ABORT_READ ? "read from" : "write to",
 			details.address);
 		context_print(context);
 		kernel_panic("unrecoverable memory access error in kernel mode");
 	} else {
-		debug_printf("Invalid memory %s access at %p\n",
+		log_error("Invalid memory %s access at %p\n",
 			details.type == ABORT_READ ? "read" : "write",
 			details.address);
 		context_print(context);
 		kernel_panic("unrecoverable memory access error in user mode");
 	}
 
+	if(details.mode == ABORT_USER)
+		spinlock_unlock(&kernel_lock);
 	return false;
 }
 
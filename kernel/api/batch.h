@@ -0,0 +1,23 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_API_BATCH_H
+#define MORDAX_API_BATCH_H
+
+#include "types.h"
+
+/**
+ * Structure describing one system call in a batch of system calls.
+ * Only system calls that neither block nor cause a reschedule can be
+ * part of a batch; other entries fail with `-ENOSYS`.
+ */
+struct mordax_batch_entry
+{
+	unsigned int syscall;	//< System call number, from `syscalls.h`.
+	void * arguments[4];	//< Arguments to the system call.
+	void * retval;		//< Return value of the system call, set by the kernel.
+};
+
+#endif
+
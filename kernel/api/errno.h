@@ -21,6 +21,8 @@
 #define EDEADLK		13
 #define ESRCH		14
 #define EIDRM		15
+#define ECONNREFUSED	16
+#define EEXIST		17
 
 // Used for internal kernel errors:
 #define EINTERNAL	15
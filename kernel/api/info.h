@@ -0,0 +1,42 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_API_INFO_H
+#define MORDAX_API_INFO_H
+
+#include "types.h"
+
+/** Version of the information page layout. */
+#define MORDAX_INFO_PAGE_VERSION	2
+
+/**
+ * Information page. A read-only copy of this structure is mapped into every
+ * process, so that frequently requested information can be read without
+ * doing a system call. The address of the page can be retrieved using the
+ * `MORDAX_THREAD_INFO_GET_INFO_PAGE` function of the thread_info system call.
+ * The page cannot be unmapped.
+ *
+ * The page is shared by all threads in the process, so it only contains
+ * information about the process. The TID of the running thread is stored in
+ * the user read-only thread ID register (TPIDRURO) instead.
+ *
+ * The `clock` field is not updated continuously. It is set to the scheduler
+ * clock when a thread of the process is scheduled to run and on every
+ * scheduler timer interrupt while it runs, so it lags behind the scheduler
+ * clock by at most one timer interval. The clock can be updated between
+ * reading its two halves, so the upper half should be read again after
+ * reading the lower half, and the read retried if it has changed.
+ */
+struct mordax_info_page
+{
+	uint32_t version;	//< Layout version, `MORDAX_INFO_PAGE_VERSION`.
+	pid_t pid;		//< PID of the process.
+	uid_t uid;		//< ID of the user owning the process.
+	gid_t gid;		//< ID of the group owning the process.
+	void * kernel_split;	//< Address of the userspace/kernel split.
+	uint64_t clock;		//< Monotonic clock, in microseconds since the scheduler started.
+} __attribute((packed));
+
+#endif
+
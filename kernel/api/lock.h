@@ -0,0 +1,29 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_API_LOCK_H
+#define MORDAX_API_LOCK_H
+
+#include "types.h"
+
+/**
+ * Contention statistics for a lock. Times are in microseconds. A thread
+ * waits for a lock from the time it blocks in `mordax_lock_aquire` until the
+ * lock is handed to it, and holds a lock from the time it gets the lock
+ * until it releases it.
+ */
+struct mordax_lock_statistics
+{
+	uint32_t id;			//< Identifier of the lock, in order of creation.
+	pid_t owner;			//< PID of the process that created the lock.
+	pid_t holder;			//< PID of the process holding the lock, or -1 if the lock is free.
+	uint32_t acquisitions;		//< Number of times the lock has been acquired.
+	uint32_t contended;		//< Number of acquisitions that had to wait for the lock.
+	uint64_t wait_time;		//< Total time threads have waited for the lock.
+	uint64_t max_wait_time;		//< Longest time a thread has waited for the lock.
+	uint64_t hold_time;		//< Total time the lock has been held.
+};
+
+#endif
+
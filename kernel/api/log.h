@@ -0,0 +1,28 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_API_LOG_H
+#define MORDAX_API_LOG_H
+
+/**
+ * @defgroup log Kernel Log
+ * The kernel log is a stream of lines, each starting with the level of the
+ * message and the time it was logged, in microseconds since the scheduler was
+ * started, as in `<2>[12.000345] Message`.
+ * @{
+ */
+
+/** Log level for errors. */
+#define MORDAX_LOG_ERROR	0
+/** Log level for warnings. */
+#define MORDAX_LOG_WARNING	1
+/** Log level for informational messages. */
+#define MORDAX_LOG_INFO		2
+/** Log level for debugging messages. */
+#define MORDAX_LOG_DEBUG	3
+
+/** @} */
+
+#endif
+
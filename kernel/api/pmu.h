@@ -0,0 +1,63 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_API_PMU_H
+#define MORDAX_API_PMU_H
+
+#include "types.h"
+
+/**
+ * @defgroup pmu Performance Counters
+ * Threads can count processor events, such as cache and TLB misses, using the
+ * performance monitoring unit of the processor. The counters are saved and
+ * restored when switching threads, so that each thread only counts the events
+ * that occur while it is running, including the work done by the kernel on
+ * its behalf.
+ * @{
+ */
+
+/** Maximum number of event counters a thread can use. */
+#define MORDAX_PMU_MAX_COUNTERS	4
+
+/**
+ * @defgroup pmu_events Common ARMv7 Event Numbers
+ * Any event number supported by the processor can be used; these are the
+ * architecturally defined events implemented by the Cortex-A8.
+ * @{
+ */
+
+#define MORDAX_PMU_EVENT_L1I_REFILL		0x01	//< Instruction cache miss.
+#define MORDAX_PMU_EVENT_ITLB_REFILL		0x02	//< Instruction TLB miss.
+#define MORDAX_PMU_EVENT_L1D_REFILL		0x03	//< Data cache miss.
+#define MORDAX_PMU_EVENT_L1D_ACCESS		0x04	//< Data cache access.
+#define MORDAX_PMU_EVENT_DTLB_REFILL		0x05	//< Data TLB miss.
+#define MORDAX_PMU_EVENT_INSTRUCTIONS		0x08	//< Instruction executed.
+#define MORDAX_PMU_EVENT_EXCEPTIONS		0x09	//< Exception taken.
+#define MORDAX_PMU_EVENT_BRANCH_MISPREDICT	0x10	//< Branch mispredicted or not predicted.
+#define MORDAX_PMU_EVENT_BRANCH_PREDICTED	0x12	//< Branch predicted.
+
+/** @} */
+
+/** Largest event number that can be counted. */
+#define MORDAX_PMU_MAX_EVENT	0xff
+
+/** Performance counter configuration for a thread. */
+struct mordax_pmu_config
+{
+	uint32_t enabled;	//< Set to 0 to stop counting and release the counters.
+	uint32_t num_events;	//< Number of event counters to use.
+	uint32_t events[MORDAX_PMU_MAX_COUNTERS];	//< Event number counted by each counter.
+};
+
+/** Performance counter values for a thread. */
+struct mordax_pmu_counters
+{
+	uint64_t cycles;	//< Processor cycles while the thread was running.
+	uint64_t events[MORDAX_PMU_MAX_COUNTERS];	//< Values of the event counters.
+};
+
+/** @} */
+
+#endif
+
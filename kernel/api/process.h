@@ -22,6 +22,20 @@
 #define MORDAX_PROCESS_PERMISSION_LOCKS		(1 << 3)
 /** Permission bit allowing processes to use IRQ objects. */
 #define MORDAX_PROCESS_PERMISSION_IRQ		(1 << 4)
+/** Permission bit allowing processes to make threads real-time threads. */
+#define MORDAX_PROCESS_PERMISSION_REALTIME	(1 << 5)
+/** Permission bit allowing processes to read the kernel log. */
+#define MORDAX_PROCESS_PERMISSION_LOG		(1 << 6)
+/** Permission bit allowing processes to map the kernel trace buffers. */
+#define MORDAX_PROCESS_PERMISSION_TRACE		(1 << 7)
+/** Permission bit allowing processes to control the sampling profiler and read its samples. */
+#define MORDAX_PROCESS_PERMISSION_PROFILE	(1 << 8)
+/**
+ * Permission bit allowing processes to read the statistics of other processes.
+ * Without it, the thread, lock and system call statistics calls only report
+ * on the calling process.
+ */
+#define MORDAX_PROCESS_PERMISSION_STATISTICS	(1 << 9)
 
 /**
  * Permission bit specifying that all permissions should be inherited from
@@ -44,6 +58,7 @@ struct mordax_process_info
 	gid_t gid;			//< GID of the new process.
 	uid_t uid;			//< UID of the new process.
 	uint32_t permissions;		//< Permissions of the new process.
+	uint32_t quantum;		//< Time slice length in microseconds, 0 for the default.
 
 	// Details for the initial thread of the new process:
 	void * entry_point;		//< Entry point for the application.
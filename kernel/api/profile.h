@@ -0,0 +1,50 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_API_PROFILE_H
+#define MORDAX_API_PROFILE_H
+
+// Only fixed size types are used, so that samples can be copied to and
+// converted by tools running on other machines:
+#include <stdint.h>
+
+/**
+ * @defgroup profile Sampling Profiler
+ * The sampling profiler interrupts the processors every time a performance
+ * counter event has occured a set number of times, and records the state of
+ * the interrupted thread in a sample buffer which is drained by userspace.
+ * @{
+ */
+
+/**
+ * Shortest sampling period, in events. Recording a sample takes thousands of
+ * cycles, so a shorter period would keep the processors busy recording
+ * samples and nothing else.
+ */
+#define MORDAX_PROFILE_MIN_PERIOD	10000
+
+/** Number of words copied from the top of the stack for each sample. */
+#define MORDAX_PROFILE_STACK_WORDS	16
+
+/** Sample flag set if the processor was interrupted while running kernel code, such as the idle thread. */
+#define MORDAX_PROFILE_SAMPLE_KERNEL	(1 << 0)
+
+/** A sample recorded by the sampling profiler. */
+struct mordax_profile_sample
+{
+	uint32_t pc;		//< Address of the interrupted instruction.
+	uint32_t lr;		//< Link register of the interrupted thread.
+	uint32_t sp;		//< Stack pointer of the interrupted thread.
+	uint16_t pid;		//< PID of the interrupted thread.
+	uint16_t cpu;		//< Processor the sample was recorded on.
+	uint32_t tid;		//< TID of the interrupted thread.
+	uint16_t flags;		//< Sample flags.
+	uint16_t stack_words;	//< Number of words copied from the stack.
+	uint32_t stack[MORDAX_PROFILE_STACK_WORDS];	//< Words from the top of the stack.
+};
+
+/** @} */
+
+#endif
+
@@ -0,0 +1,15 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_API_SERVICE_H
+#define MORDAX_API_SERVICE_H
+
+/** Default maximum number of pending connections to a service. */
+#define MORDAX_SERVICE_DEFAULT_BACKLOG	8
+
+/** Highest allowed maximum number of pending connections to a service. */
+#define MORDAX_SERVICE_MAX_BACKLOG	64
+
+#endif
+
@@ -0,0 +1,34 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_API_SOCKET_H
+#define MORDAX_API_SOCKET_H
+
+#include "types.h"
+
+/**
+ * Socket flag for the vectored send and receive system calls that makes
+ * them fail with `-EWOULDBLOCK` instead of blocking the calling thread.
+ */
+#define MORDAX_SOCKET_NONBLOCK	(1 << 0)
+
+/** Maximum number of messages in the message queue of a socket. */
+#define MORDAX_SOCKET_MAX_QUEUE_DEPTH	16
+
+/** Maximum number of segments in a vectored send or receive. */
+#define MORDAX_SOCKET_MAX_IOV	8
+
+/**
+ * Memory segment used for vectored sending and receiving. The segments of a
+ * message are sent as one message, and a received message is split across
+ * the segments of the receive buffer.
+ */
+struct mordax_iovec
+{
+	void * base;	//< Start of the segment.
+	size_t length;	//< Length of the segment.
+};
+
+#endif
+
@@ -0,0 +1,49 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_API_SYSCALL_STATISTICS_H
+#define MORDAX_API_SYSCALL_STATISTICS_H
+
+#include "types.h"
+
+/**
+ * @defgroup syscall_statistics System Call Statistics
+ * The kernel counts the calls to each system call and records how long they
+ * take, both for all processes and for each process. The statistics are read
+ * with the `MORDAX_SYSTEM_SYSCALL_STATISTICS` function of the system syscall,
+ * which takes a PID, a pointer to an array of `mordax_syscall_statistics`
+ * structures indexed by system call number and the length of the array, and
+ * returns the number of system call numbers.
+ * @{
+ */
+
+/** PID used to get the system call statistics for all processes. */
+#define MORDAX_SYSCALL_STATISTICS_ALL	-1
+
+/** Number of buckets in a system call latency histogram. */
+#define MORDAX_SYSCALL_HISTOGRAM_BUCKETS	24
+
+/**
+ * Statistics for one system call. The latency is the number of processor
+ * cycles spent in the kernel from entering to leaving the system call
+ * handler, including the time spent waiting for the kernel lock. When a
+ * system call blocks, the time until the calling thread is woken up is not
+ * included.
+ */
+struct mordax_syscall_statistics
+{
+	uint32_t count;		//< Number of times the system call has been made.
+	uint64_t cycles;	//< Total latency of the calls, in cycles.
+	/**
+	 * Latency histogram. Bucket `n` counts the calls with a latency of
+	 * 2^n to 2^(n+1) - 1 cycles; the first bucket also counts calls with a
+	 * latency of 0 and the last bucket all calls with a longer latency.
+	 */
+	uint32_t histogram[MORDAX_SYSCALL_HISTOGRAM_BUCKETS];
+};
+
+/** @} */
+
+#endif
+
@@ -59,5 +59,50 @@
 // Resource syscalls:
 #define MORDAX_SYSCALL_RESOURCE_DESTROY	28
 
+// Batch syscall:
+#define MORDAX_SYSCALL_BATCH		29
+
+// Scheduler statistics syscall:
+#define MORDAX_SYSCALL_THREAD_STATISTICS	30
+
+// Real-time scheduling syscall:
+#define MORDAX_SYSCALL_THREAD_SET_REALTIME	31
+
+// Wait set syscalls:
+#define MORDAX_SYSCALL_WAITSET_CREATE	32
+#define MORDAX_SYSCALL_WAITSET_ADD	33
+#define MORDAX_SYSCALL_WAITSET_REMOVE	34
+#define MORDAX_SYSCALL_WAITSET_WAIT	35
+
+// Socket message queue syscall:
+#define MORDAX_SYSCALL_SOCKET_SET_QUEUE_DEPTH	36
+
+// Vectored socket syscalls:
+#define MORDAX_SYSCALL_SOCKET_SENDV	37
+#define MORDAX_SYSCALL_SOCKET_RECEIVEV	38
+
+// Service connection management syscalls:
+#define MORDAX_SYSCALL_SERVICE_ACCEPT		39
+#define MORDAX_SYSCALL_SERVICE_SET_BACKLOG	40
+
+// Kernel log syscall:
+#define MORDAX_SYSCALL_LOG_READ		41
+
+// Kernel trace syscall:
+#define MORDAX_SYSCALL_TRACE_MAP	42
+
+// Performance counter syscall:
+#define MORDAX_SYSCALL_THREAD_PMU	43
+
+// Sampling profiler syscalls:
+#define MORDAX_SYSCALL_PROFILE_START	44
+#define MORDAX_SYSCALL_PROFILE_READ	45
+
+// Lock statistics syscall:
+#define MORDAX_SYSCALL_LOCK_STATISTICS	46
+
+// Thread sleep syscall:
+#define MORDAX_SYSCALL_THREAD_SLEEP	47
+
 #endif
 
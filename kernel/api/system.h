@@ -9,6 +9,8 @@
 #define MORDAX_SYSTEM_DEBUG	0
 // Gets the address of the userspace/kernel split:
 #define MORDAX_SYSTEM_GETSPLIT	1
+// Gets system call statistics, see syscall_statistics.h:
+#define MORDAX_SYSTEM_SYSCALL_STATISTICS	2
 
 #endif
 
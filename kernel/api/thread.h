@@ -5,13 +5,42 @@
 #ifndef MORDAX_API_THREAD_H
 #define MORDAX_API_THREAD_H
 
+// The function numbers are also used by the assembly code of the Mordax library:
+#ifndef __ASSEMBLER__
 #include "types.h"
+#endif
 
 // Function numbers for the thread_info system call:
 #define MORDAX_THREAD_INFO_GET_TID	0
 #define MORDAX_THREAD_INFO_GET_PID	1
 #define MORDAX_THREAD_INFO_GET_UID	2
 #define MORDAX_THREAD_INFO_GET_GID	3
+#define MORDAX_THREAD_INFO_GET_INFO_PAGE	4
+
+// Thread states reported by the thread_statistics system call:
+#define MORDAX_THREAD_STATE_RUNNING	0
+#define MORDAX_THREAD_STATE_READY	1
+#define MORDAX_THREAD_STATE_BLOCKING	2
+
+#ifndef __ASSEMBLER__
+
+/**
+ * Scheduler statistics for a thread. Times are measured in cycles of the
+ * processor cycle counter.
+ */
+struct mordax_thread_statistics
+{
+	pid_t pid;			//< PID of the process owning the thread.
+	tid_t tid;			//< TID of the thread.
+	uint32_t cpu;			//< Processor the thread runs on.
+	uint32_t state;			//< Scheduling state of the thread.
+	uint64_t runtime;		//< Time spent running.
+	uint64_t wait_time;		//< Time spent ready to run, waiting for a processor.
+	uint32_t voluntary_switches;	//< Number of times the thread blocked or yielded.
+	uint32_t involuntary_switches;	//< Number of times the thread was preempted.
+};
+
+#endif
 
 #endif
 
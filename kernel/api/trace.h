@@ -0,0 +1,77 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_API_TRACE_H
+#define MORDAX_API_TRACE_H
+
+// Only fixed size types are used, so that the trace buffer can be read by
+// tools running on other machines:
+#include <stdint.h>
+
+/**
+ * @defgroup trace Kernel Tracing
+ * The kernel records scheduling, system call, interrupt, lock and page fault
+ * events into a trace buffer for each processor. The buffers can be mapped
+ * read-only into a process and copied while the kernel keeps writing to them.
+ * @{
+ */
+
+/** Version of the trace buffer layout. */
+#define MORDAX_TRACE_VERSION	1
+
+/** A thread is switched to. `data` is the PID and `argument` the TID of the thread. */
+#define MORDAX_TRACE_SWITCH		1
+/** A system call is entered. `data` is the system call number. */
+#define MORDAX_TRACE_SYSCALL_ENTRY	2
+/**
+ * A system call returns to the calling thread without blocking. `data` is the
+ * system call number and `argument` the return value. System calls that block
+ * end with the next switch event instead.
+ */
+#define MORDAX_TRACE_SYSCALL_EXIT	3
+/** An interrupt handler is entered. `data` is the IRQ number. */
+#define MORDAX_TRACE_IRQ_ENTRY		4
+/** An interrupt handler returns. `data` is the IRQ number. */
+#define MORDAX_TRACE_IRQ_EXIT		5
+/** The running thread blocks on a lock. `argument` is the identifier of the lock, as in its statistics. */
+#define MORDAX_TRACE_LOCK_BLOCK		6
+/** A thread blocking on a lock is woken up. `data` is the PID and `argument` the TID of the thread. */
+#define MORDAX_TRACE_LOCK_WAKE		7
+/** A page fault occurs. `data` is 1 for writes and 0 for reads, `argument` is the faulting address. */
+#define MORDAX_TRACE_PAGE_FAULT		8
+
+/** Trace event record. */
+struct mordax_trace_event
+{
+	uint64_t timestamp;	//< Cycle count of the processor when the event occured.
+	uint16_t type;		//< Type of the event.
+	uint16_t data;		//< Small event argument.
+	uint32_t argument;	//< Event argument.
+};
+
+/**
+ * Trace buffer of a processor. The events are stored in a ring, where the
+ * event number `n` is stored in `events[n % length]`. A reader can detect
+ * events that were overwritten while copying them by reading `head` again
+ * after copying: only events numbered higher than `head - length` are valid.
+ */
+struct mordax_trace_buffer
+{
+	uint32_t version;		//< Layout version, `MORDAX_TRACE_VERSION`.
+	uint32_t cpu;			//< Index of the processor.
+	uint32_t length;		//< Number of events in the ring.
+	volatile uint32_t head;		//< Number of events recorded.
+
+	// Cycle count and scheduler clock, in microseconds, read at the same
+	// time. Used for converting timestamps to time:
+	volatile uint64_t clock_cycles;
+	volatile uint64_t clock_time;
+
+	struct mordax_trace_event events[];
+};
+
+/** @} */
+
+#endif
+
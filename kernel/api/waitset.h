@@ -0,0 +1,32 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_API_WAITSET_H
+#define MORDAX_API_WAITSET_H
+
+#include "types.h"
+
+/**
+ * Event indicating that a resource in a wait set has become ready: a
+ * message has been sent to a socket, a client is connecting to a service,
+ * a lock has been released or an IRQ has occured.
+ */
+#define MORDAX_WAITSET_READY	(1 << 0)
+
+/** Event indicating that the endpoint of a socket in a wait set has been closed. */
+#define MORDAX_WAITSET_HANGUP	(1 << 1)
+
+/**
+ * Structure describing a resource in a wait set that has become ready.
+ * Events are edge-triggered; each event is only reported once, by the first
+ * call to `mordax_waitset_wait` after the event has occured.
+ */
+struct mordax_waitset_event
+{
+	mordax_resource_t resource;	//< Identifier of the resource that is ready.
+	unsigned int events;		//< Events that have occured on the resource.
+};
+
+#endif
+
@@ -16,7 +16,13 @@ CONFIG += \
 	-DCONFIG_DEFAULT_STACK_BASE=\(0x80000000U-CONFIG_DEFAULT_STACK_SIZE\) \
 	-DCONFIG_LITTLE_ENDIAN \
 	-DCONFIG_KERNEL_SPLIT=0x80000000U \
-	-DCONFIG_IPC_BUFFER_LENGTH=4096
+	-DCONFIG_IPC_BUFFER_LENGTH=4096 \
+	-DCONFIG_LOG_BUFFER_SIZE=16384 \
+	-DCONFIG_LOG_LEVEL=$(KERNEL_LOG_LEVEL) \
+	-DCONFIG_TRACE_EVENTS=4096 \
+	-DCONFIG_PROFILE_SAMPLES=1024 \
+	-DCONFIG_SYSCALL_STATISTICS \
+	-DCONFIG_MAX_CPUS=1
 
 # Target linker script:
 TARGET_LDSCRIPT := armv7/mordax.ld
@@ -24,10 +30,14 @@ TARGET_LDSCRIPT := armv7/mordax.ld
 # Target dependent source files:
 ASSEMBLER_FILES += \
 	armv7/bootstrap.S \
+	armv7/cycles.S \
 	armv7/endian.S \
 	armv7/idle_thread.S \
 	armv7/interrupts.S \
-	armv7/log2.S
+	armv7/log2.S \
+	armv7/pmu.S \
+	armv7/smp.S \
+	armv7/vfp.S
 SOURCE_FILES += \
 	armv7/abort.c \
 	armv7/context.c \
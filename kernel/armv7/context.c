@@ -6,10 +6,33 @@
 #include "registers.h"
 
 #include "../context.h"
+#include "../cycles.h"
 #include "../debug.h"
 #include "../mm.h"
+#include "../pmu.h"
+#include "../smp.h"
 #include "../utils.h"
 
+#include "../api/errno.h"
+
+// VFP functions exported from vfp.S:
+extern void vfp_set_enabled(bool enabled);
+extern bool vfp_is_enabled(void);
+extern void vfp_save(struct vfp_state * state);
+extern void vfp_restore(struct vfp_state * state);
+
+// Contexts whose VFP registers are currently loaded into the VFP unit of
+// each processor:
+static struct thread_context * vfp_owner[CONFIG_MAX_CPUS];
+
+// Contexts whose performance counters are currently running on each processor.
+// Unlike the VFP registers, the counters are always saved when a context is
+// switched out, so a context can only be the owner on the processor it runs on:
+static struct thread_context * pmu_owner[CONFIG_MAX_CPUS];
+
+// Adds the values of the running counters to a set of counter values:
+static void pmu_add_running(struct pmu_state * state, struct mordax_pmu_counters * counters);
+
 struct thread_context * context_new(void)
 {
 	struct thread_context * retval = mm_allocate(sizeof(struct thread_context),
@@ -23,12 +46,172 @@ struct thread_context * context_new(void)
 
 void context_free(struct thread_context * context)
 {
+	for(unsigned int cpu = 0; cpu < CONFIG_MAX_CPUS; ++cpu)
+	{
+		if(vfp_owner[cpu] == context)
+			vfp_owner[cpu] = 0;
+		if(pmu_owner[cpu] == context)
+		{
+			pmu_stop(context->pmu->num_events);
+			pmu_owner[cpu] = 0;
+		}
+	}
+	mm_free(context->vfp);
+	mm_free(context->pmu);
 	mm_free(context);
 }
 
 void context_copy(struct thread_context * dest, struct thread_context * src)
 {
+	// The VFP and performance counter states belong to the context they were
+	// allocated for and are not copied:
+	struct vfp_state * dest_vfp = dest->vfp;
+	struct pmu_state * dest_pmu = dest->pmu;
 	memcpy(dest, src, sizeof(struct thread_context));
+	dest->vfp = dest_vfp;
+	dest->pmu = dest_pmu;
+}
+
+void context_fpu_switch(struct thread_context * context)
+{
+	struct thread_context ** owner = &vfp_owner[cpu_get_id()];
+
+#if CONFIG_MAX_CPUS > 1
+	// A thread can be moved to another processor while it is not running,
+	// and its registers cannot be fetched from the unit of this processor
+	// afterwards, so they are saved when the thread is switched out:
+	if(*owner != 0 && *owner != context)
+	{
+		vfp_set_enabled(true);
+		vfp_save((*owner)->vfp);
+		*owner = 0;
+	}
+#endif
+
+	// Only leave the unit enabled if it still holds the registers of the incoming context:
+	vfp_set_enabled(context == *owner);
+}
+
+bool context_fpu_trap(struct thread_context * context)
+{
+	// Only user-mode code may use the VFP unit, and if the unit is already
+	// enabled, the instruction is really undefined:
+	if((context->spsr & PROCESSOR_MODE_MASK) != PROCESSOR_MODE_USR || vfp_is_enabled())
+		return false;
+
+	// Allocate space for the registers before using the unit, so that the
+	// registers of the current owner are kept if there is no memory:
+	struct thread_context ** owner = &vfp_owner[cpu_get_id()];
+	if(*owner != 0 && (*owner)->vfp == 0)
+	{
+		(*owner)->vfp = mm_allocate(sizeof(struct vfp_state), 8, MM_MEM_NORMAL);
+		if((*owner)->vfp == 0)
+			return false;
+	}
+
+	if(context->vfp == 0)
+	{
+		context->vfp = mm_allocate(sizeof(struct vfp_state), 8, MM_MEM_NORMAL);
+		if(context->vfp == 0)
+			return false;
+		memclr(context->vfp, sizeof(struct vfp_state));
+	}
+
+	vfp_set_enabled(true);
+	if(*owner != 0)
+		vfp_save((*owner)->vfp);
+	vfp_restore(context->vfp);
+	*owner = context;
+
+	// Retry the instruction that caused the trap:
+	context->pc -= (context->spsr & (1 << CPSR_T)) ? 2 : 4;
+	return true;
+}
+
+unsigned int context_pmu_get_num_counters(void)
+{
+	unsigned int retval = pmu_get_num_counters();
+#ifdef CONFIG_PROFILE_SAMPLES
+	// The last counter is used by the sampling profiler:
+	retval = retval > 0 ? retval - 1 : 0;
+#endif
+	return min(retval, MORDAX_PMU_MAX_COUNTERS);
+}
+
+int context_pmu_configure(struct thread_context * context, const struct mordax_pmu_config * config)
+{
+	if(config->enabled && config->num_events > context_pmu_get_num_counters())
+		return -EINVAL;
+	for(unsigned int i = 0; config->enabled && i < config->num_events; ++i)
+	{
+		if(config->events[i] > MORDAX_PMU_MAX_EVENT)
+			return -EINVAL;
+	}
+
+	struct thread_context ** owner = &pmu_owner[cpu_get_id()];
+	if(*owner == context)
+	{
+		pmu_stop(context->pmu->num_events);
+		*owner = 0;
+	}
+
+	if(!config->enabled)
+	{
+		mm_free(context->pmu);
+		context->pmu = 0;
+		return 0;
+	}
+
+	if(context->pmu == 0)
+	{
+		context->pmu = mm_allocate(sizeof(struct pmu_state), 8, MM_MEM_NORMAL);
+		if(context->pmu == 0)
+			return -ENOMEM;
+	}
+
+	memclr(context->pmu, sizeof(struct pmu_state));
+	context->pmu->num_events = config->num_events;
+	memcpy(context->pmu->events, config->events, config->num_events * sizeof(uint32_t));
+
+	// Start counting right away, as the context is running:
+	context_pmu_switch(context);
+	return 0;
+}
+
+int context_pmu_read(struct thread_context * context, struct mordax_pmu_counters * counters)
+{
+	if(context->pmu == 0)
+		return -ENOENT;
+
+	memcpy(counters, &context->pmu->counters, sizeof(struct mordax_pmu_counters));
+	if(pmu_owner[cpu_get_id()] == context)
+		pmu_add_running(context->pmu, counters);
+	return 0;
+}
+
+void context_pmu_switch(struct thread_context * context)
+{
+	struct thread_context ** owner = &pmu_owner[cpu_get_id()];
+	if(*owner == context)
+		return;
+
+	// Save the counts of the previous context:
+	if(*owner != 0)
+	{
+		pmu_stop((*owner)->pmu->num_events);
+		pmu_add_running((*owner)->pmu, &(*owner)->pmu->counters);
+		*owner = 0;
+	}
+
+	// The event counters restart from zero, and the counts are added to the
+	// saved counts when the context is switched out again, so that the 32-bit
+	// hardware counters never wrap around:
+	if(context->pmu != 0)
+	{
+		context->pmu->cycles_start = cycles_read();
+		pmu_start(context->pmu->events, context->pmu->num_events);
+		*owner = context;
+	}
 }
 
 void * context_get_syscall_argument(struct thread_context * context, unsigned num)
@@ -39,11 +222,22 @@ void * context_get_syscall_argument(struct thread_context * context, unsigned nu
 		return (void *) context->r[num];
 }
 
+void context_set_syscall_argument(struct thread_context * context, unsigned num, void * value)
+{
+	if(num <= 3)
+		context->r[num] = (uint32_t) value;
+}
+
 void context_set_syscall_retval(struct thread_context * context, void * value)
 {
 	context->r[0] = (uint32_t) value;
 }
 
+void * context_get_syscall_retval(struct thread_context * context)
+{
+	return (void *) context->r[0];
+}
+
 void context_print(struct thread_context * context)
 {
 	debug_printf("Register contents:\n");
@@ -73,13 +267,59 @@ void context_set_mode(struct thread_context * context, enum context_processor_mo
 		context->spsr |= PROCESSOR_MODE_SYS;
 }
 
+enum context_processor_mode context_get_mode(struct thread_context * context)
+{
+	if((context->spsr & PROCESSOR_MODE_MASK) == PROCESSOR_MODE_USR)
+		return CONTEXT_USERMODE;
+	else
+		return CONTEXT_KERNELMODE;
+}
+
 void context_set_pc(struct thread_context * context, void * pc)
 {
 	context->pc = (uint32_t) pc;
 }
 
+void * context_get_pc(struct thread_context * context)
+{
+	return (void *) context->pc;
+}
+
 void context_set_sp(struct thread_context * context, void * sp)
 {
 	context->r[13] = (uint32_t) sp;
 }
 
+void * context_get_sp(struct thread_context * context)
+{
+	return (void *) context->r[13];
+}
+
+void * context_get_lr(struct thread_context * context)
+{
+	return (void *) context->r[14];
+}
+
+void context_set_current(struct thread_context * context)
+{
+	// The current context is kept in the PL1-only thread ID register
+	// (TPIDRPRW), which is private to each processor:
+	asm volatile("mcr p15, 0, %[context], c13, c0, 4\n\t" :: [context] "r" (context));
+}
+
+void context_set_thread_id(tid_t tid)
+{
+	// Write the TID to the user read-only thread ID register (TPIDRURO):
+	asm volatile("mcr p15, 0, %[tid], c13, c0, 3\n\t" :: [tid] "r" (tid));
+}
+
+static void pmu_add_running(struct pmu_state * state, struct mordax_pmu_counters * counters)
+{
+	uint32_t values[MORDAX_PMU_MAX_COUNTERS];
+	pmu_read(values, state->num_events);
+
+	counters->cycles += cycles_read() - state->cycles_start;
+	for(unsigned int i = 0; i < state->num_events; ++i)
+		counters->events[i] += values[i];
+}
+
@@ -6,6 +6,7 @@
 #define MORDAX_ARMv7_CONTEXT_H
 
 #include "../context.h"
+#include "../api/pmu.h"
 #include "../api/types.h"
 
 /**
@@ -13,12 +14,34 @@
  * @{
  */
 
-/** Stored thread context structure. */
+/** Stored VFP/NEON register bank. */
+struct vfp_state
+{
+	uint64_t d[32];	//< Registers d0 - d31
+	uint32_t fpscr;	//< Floating-point status and control register
+} __attribute((packed));
+
+/** Performance counter state of a thread. */
+struct pmu_state
+{
+	uint32_t num_events;	//< Number of event counters used.
+	uint32_t events[MORDAX_PMU_MAX_COUNTERS];	//< Event number counted by each counter.
+	uint32_t cycles_start;	//< Cycle counter value when the counters were loaded.
+	struct mordax_pmu_counters counters;	//< Counts from the previous time slices.
+};
+
+/**
+ * Stored thread context structure. The layout of the first fields is used
+ * by the exception handlers in interrupts.S.
+ */
 struct thread_context
 {
 	uint32_t spsr;	//< Stored status register
 	uint32_t pc;	//< Exception return address
 	uint32_t r[15];	//< Registers r0 - r14
+
+	struct vfp_state * vfp;	//< VFP/NEON registers, allocated on first use.
+	struct pmu_state * pmu;	//< Performance counters, allocated when configured.
 } __attribute((packed));
 
 /** @} */
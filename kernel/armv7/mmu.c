@@ -28,7 +28,7 @@ struct mmu_translation_table
 struct lookup_table_entry
 {
 	void * virtual, * physical;
-	enum { PT_ADDRESS, MEM_ADDRESS } type;
+	enum { PT_ADDRESS, MEM_ADDRESS, SHARED_ADDRESS } type;
 };
 
 // The kernel translation table:
@@ -48,9 +48,9 @@ static struct mm_object_stack * pt_stack;
 // Function called for freeing an entry in a lookup table:
 static void free_lookup_entry(struct lookup_table_entry *);
 
-// Maps one page of memory:
+// Maps one page of memory, shared pages are not freed with the translation table:
 static void * mmu_map_page(struct mmu_translation_table * t, physical_ptr physical, void * virtual,
-	enum mordax_memory_type type, enum mordax_memory_permissions permissions);
+	enum mordax_memory_type type, enum mordax_memory_permissions permissions, bool shared);
 // Unmaps one page of memory:
 static void mmu_unmap_page(struct mmu_translation_table * t, void * virtual);
 // Changes the attributes for one page of memory:
@@ -64,7 +64,8 @@ static uint32_t * get_pt_address(uint32_t * translation_table, int index);
 // Creates a lookup table entry for a page table:
 static inline struct lookup_table_entry * lookup_entry_pt(void * virtual);
 // Creates a lookup table entry for a memory page:
-static inline struct lookup_table_entry * lookup_entry_mem(physical_ptr physical, void * virtual);
+static inline struct lookup_table_entry * lookup_entry_mem(physical_ptr physical, void * virtual,
+	bool shared);
 
 // Gets the type bits for the specified small page type:
 static inline uint32_t small_page_type_bits(enum mordax_memory_type type);
@@ -231,7 +232,21 @@ void * mmu_map(struct mmu_translation_table * t, physical_ptr physical, void * v
 	for(unsigned i = 0; i < size >> 12; ++i)
 	{
 		mmu_map_page(t, (physical_ptr) ((uint32_t) physical + (i << 12)),
-			(void *) ((uint32_t) virtual + (i << 12)), type, permissions);
+			(void *) ((uint32_t) virtual + (i << 12)), type, permissions, false);
+	}
+
+	return virtual;
+}
+
+void * mmu_map_shared(struct mmu_translation_table * t, void * kernel_virtual, void * virtual,
+	size_t size, enum mordax_memory_type type, enum mordax_memory_permissions permissions)
+{
+	size = (size + 4095) & -4096;
+	for(unsigned i = 0; i < size >> 12; ++i)
+	{
+		// The kernel memory is not necessarily physically contiguous:
+		mmu_map_page(t, mmu_virtual_to_physical((void *) ((uint32_t) kernel_virtual + (i << 12))),
+			(void *) ((uint32_t) virtual + (i << 12)), type, permissions, true);
 	}
 
 	return virtual;
@@ -264,7 +279,7 @@ static void mmu_change_page_attributes(struct mmu_translation_table * t, void *
 		return;
 
 	uint32_t physical = page_table[((uint32_t) virtual & 0xfffff) >> 12] & MMU_SMALL_PAGE_BASE_MASK;
-	debug_printf("Altering mapping of %p -> %p...\n", (void *) physical, virtual);
+	log_debug("Altering mapping of %p -> %p...\n", (void *) physical, virtual);
 
 	uint32_t entry = physical | MMU_SMALL_PAGE_TYPE |
 		small_page_type_bits(type) | small_page_permission_bits(permissions);
@@ -289,6 +304,27 @@ void mmu_unmap(struct mmu_translation_table * t, void * virtual, size_t size)
 		mmu_unmap_page(t, (void *) ((uint32_t) virtual + (i << 12)));
 }
 
+bool mmu_is_mapped(struct mmu_translation_table * t, const void * virtual, size_t size)
+{
+	uint32_t start = (uint32_t) virtual & -4096;
+	size = (((uint32_t) virtual & 0xfff) + size + 4095) & -4096;
+
+	for(uint32_t address = start; address - start < size; address += 4096)
+	{
+		uint32_t * table;
+		if(address >= MMU_KERNEL_SPLIT_ADDRESS || t == 0)
+			table = kernel_translation_table;
+		else
+			table = t->table;
+
+		uint32_t * page_table = get_pt_address(table, address >> 20);
+		if(page_table != 0 && (page_table[pt_index(address)] & 3) != 0)
+			return true;
+	}
+
+	return false;
+}
+
 physical_ptr mmu_virtual_to_physical(void * virtual)
 {
 	uint32_t retval, offset = (uint32_t) virtual & 0xfff;
@@ -309,6 +345,24 @@ physical_ptr mmu_virtual_to_physical(void * virtual)
 	return (void *) ((retval & 0xfffff000) + offset);
 }
 
+bool mmu_user_readable(const void * virtual)
+{
+	uint32_t result;
+
+	// Translate the address as a user-mode read (ATS1CUR) and check the
+	// fault bit of the result (PAR.F):
+	asm volatile(
+		"mcr p15, 0, %[virtual], c7, c8, 2\n\t"
+		"isb\n\t"
+		"mrc p15, 0, %[result], c7, c4, 0\n\t"
+		: [result] "=r" (result)
+		: [virtual] "r" ((uint32_t) virtual & 0xfffff000)
+		:
+	);
+
+	return (result & 1) == 0;
+}
+
 void * mmu_physical_to_virtual(physical_ptr physical)
 {
 	if(rbtree_key_exists(kernel_lookup_table, physical))
@@ -318,7 +372,7 @@ void * mmu_physical_to_virtual(physical_ptr physical)
 }
 
 static void * mmu_map_page(struct mmu_translation_table * t, physical_ptr physical, void * virtual,
-	enum mordax_memory_type type, enum mordax_memory_permissions permissions)
+	enum mordax_memory_type type, enum mordax_memory_permissions permissions, bool shared)
 {
 	uint32_t * table;
 	if((uint32_t) virtual >= MMU_KERNEL_SPLIT_ADDRESS || t == 0)
@@ -353,9 +407,9 @@ static void * mmu_map_page(struct mmu_translation_table * t, physical_ptr physic
 
 	// Insert the page into the lookup table:
 	if(table == kernel_translation_table)
-		rbtree_insert(kernel_lookup_table, physical, lookup_entry_mem(physical, virtual));
+		rbtree_insert(kernel_lookup_table, physical, lookup_entry_mem(physical, virtual, shared));
 	else
-		rbtree_insert(t->lookup_table, physical, lookup_entry_mem(physical, virtual));
+		rbtree_insert(t->lookup_table, physical, lookup_entry_mem(physical, virtual, shared));
 
 	return virtual;
 }
@@ -373,14 +427,19 @@ static void mmu_unmap_page(struct mmu_translation_table * t, void * virtual)
 	// Round the address down:
 	virtual = (void *) ((uint32_t) virtual & -4096);
 	if(table == kernel_translation_table)
-		rbtree_delete(kernel_lookup_table, mmu_virtual_to_physical(virtual));
-	else
-		rbtree_delete(t->lookup_table, mmu_virtual_to_physical(virtual));
+		mm_free(rbtree_delete(kernel_lookup_table, mmu_virtual_to_physical(virtual)));
+	else {
+		// Memory owned by the process is freed along with the mapping, in
+		// the same way as when the translation table is freed:
+		struct lookup_table_entry * entry = rbtree_delete(t->lookup_table, mmu_virtual_to_physical(virtual));
+		if(entry != 0)
+			free_lookup_entry(entry);
+	}
 
 	if(page_table != 0)
 		page_table[((uint32_t) virtual & 0xfffff) >> 12] = 0;
 	else
-		debug_printf("Cannot unmap memory: no existing entry\n");
+		log_warning("Cannot unmap memory: no existing entry\n");
 }
 
 void mmu_invalidate(void)
@@ -405,13 +464,14 @@ static inline struct lookup_table_entry * lookup_entry_pt(void * virtual)
 	return retval;
 }
 
-static inline struct lookup_table_entry * lookup_entry_mem(physical_ptr physical, void * virtual)
+static inline struct lookup_table_entry * lookup_entry_mem(physical_ptr physical, void * virtual,
+	bool shared)
 {
 	struct lookup_table_entry * retval = mm_allocate(sizeof(struct lookup_table_entry),
 		MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
 	retval->virtual = virtual;
 	retval->physical = physical;
-	retval->type = MEM_ADDRESS;
+	retval->type = shared ? SHARED_ADDRESS : MEM_ADDRESS;
 	return retval;
 }
 
@@ -27,6 +27,15 @@
 
 /** @} */
 
+/**
+ * @defgroup cpsr Program Status Register (CPSR/SPSR) Defines
+ * @{
+ */
+
+#define CPSR_T		5
+
+/** @} */
+
 /**
  * @defgroup nmrr Normal Memory Remap Register (NMRR) Defines
  * @{
@@ -92,6 +101,28 @@
 #define ACR_L1NEON	5
 #define ACR_ASA		4
 
+/** @} */
+
+/**
+ * @defgroup cpacr Coprocessor Access Control Register (CPACR) Defines
+ * @{
+ */
+
+/** Bit number of the access field for the specified coprocessor. */
+#define CPACR_CP(x)	((x) << 1)
+
+/** Full access to a coprocessor from both PL0 and PL1. */
+#define CPACR_FULL	0b11
+
+/** @} */
+
+/**
+ * @defgroup fpexc Floating-Point Exception Register (FPEXC) Defines
+ * @{
+ */
+
+#define FPEXC_EN	30
+
 /** @} */
 /** @} */
 
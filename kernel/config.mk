@@ -23,19 +23,23 @@ SOURCE_FILES += \
 	abort.c \
 	debug.c \
 	dt.c \
+	handle_table.c \
 	irq.c \
 	kernel.c \
 	lock.c \
 	mm.c \
 	number_allocator.c \
 	process.c \
+	profile.c \
 	scheduler.c \
 	service.c \
 	socket.c \
 	syscall.c \
 	thread.c \
+	trace.c \
 	undef.c \
-	utils.c
+	utils.c \
+	waitset.c
 
 # Include build configuration files for the drivers:
 include drivers/config.mk
@@ -5,6 +5,9 @@
 #ifndef MORDAX_CONTEXT_H
 #define MORDAX_CONTEXT_H
 
+#include "api/pmu.h"
+#include "api/types.h"
+
 /**
  * @defgroup context Thread Context Functions
  * @{
@@ -13,14 +16,17 @@
 /** Target-dependent thread context structure. */
 struct thread_context;
 
+enum context_processor_mode { CONTEXT_USERMODE, CONTEXT_KERNELMODE };
+
 /**
- * Pointer to the current user-space context. When in kernel-mode code, this
- * variable always points to the context information that is stored by the
- * interrupt handling code when entering kernel-mode.
+ * Sets the context block of the active thread on the current processor.
+ * The interrupt handling code stores the user-space context directly into
+ * this block when entering kernel-mode, and restores the context it refers
+ * to when returning. Switching threads is therefore done by changing the
+ * current context.
+ * @param context the context block of the thread to run.
  */
-extern struct thread_context * current_context;
-
-enum context_processor_mode { CONTEXT_USERMODE, CONTEXT_KERNELMODE };
+void context_set_current(struct thread_context * context);
 
 /**
  * Creates a new thread context with default values for the registers.
@@ -41,6 +47,59 @@ void context_free(struct thread_context * context);
  */
 void context_copy(struct thread_context * dest, struct thread_context * src);
 
+/**
+ * Prepares the floating point unit for running the thread with the specified
+ * context. The floating point registers are not switched here; instead the
+ * unit is disabled, so that the first floating point instruction executed by
+ * the thread traps and `context_fpu_trap` can switch the registers. On
+ * multiprocessor systems, the registers of the previous user are saved here,
+ * as its thread may be moved to another processor.
+ * @param context the context that is about to be restored.
+ */
+void context_fpu_switch(struct thread_context * context);
+
+/**
+ * Handles an undefined instruction trap caused by use of the disabled
+ * floating point unit. The floating point registers of the previous user are
+ * stored and the registers of the specified context are loaded.
+ * @param context the context of the thread that caused the trap.
+ * @return `true` if the trap was handled and the instruction should be
+ *         retried, `false` if the instruction is really undefined or there
+ *         is not enough memory for the floating point registers.
+ */
+bool context_fpu_trap(struct thread_context * context);
+
+/**
+ * Gets the number of event counters that threads can use.
+ * @return the number of event counters, at most `MORDAX_PMU_MAX_COUNTERS`.
+ */
+unsigned int context_pmu_get_num_counters(void);
+
+/**
+ * Configures the performance counters of the current context of the calling
+ * processor and starts counting. All counters of the context are reset.
+ * @param context the current context.
+ * @param config the counter configuration.
+ * @return 0 on success or a negative error code on failure.
+ */
+int context_pmu_configure(struct thread_context * context, const struct mordax_pmu_config * config);
+
+/**
+ * Reads the performance counters of a thread context.
+ * @param context the context to read the counters of.
+ * @param counters pointer to where the counter values are stored.
+ * @return 0 on success or `-ENOENT` if the context has no counters configured.
+ */
+int context_pmu_read(struct thread_context * context, struct mordax_pmu_counters * counters);
+
+/**
+ * Switches the performance counters of the current processor to the
+ * specified context. The counters of the previous context are stopped and
+ * saved, and the counters of the incoming context, if it has any, are loaded.
+ * @param context the context that is about to be restored.
+ */
+void context_pmu_switch(struct thread_context * context);
+
 /**
  * Extracts a specific argument of an SVC from a thread context.
  * @param context the context to use.
@@ -49,6 +108,14 @@ void context_copy(struct thread_context * dest, struct thread_context * src);
  */
 void * context_get_syscall_argument(struct thread_context * context, unsigned num);
 
+/**
+ * Sets a specific argument of an SVC in a thread context.
+ * @param context the context to use.
+ * @param num the argument number to set, in the range 0-3.
+ * @param value the value to set the argument to.
+ */
+void context_set_syscall_argument(struct thread_context * context, unsigned num, void * value);
+
 /**
  * Sets the return value of an SVC in a thread context.
  * @param context the context to use.
@@ -56,6 +123,13 @@ void * context_get_syscall_argument(struct thread_context * context, unsigned nu
  */
 void context_set_syscall_retval(struct thread_context * context, void * value);
 
+/**
+ * Gets the return value of an SVC from a thread context.
+ * @param context the context to use.
+ * @return the SVC return value stored in the context.
+ */
+void * context_get_syscall_retval(struct thread_context * context);
+
 /**
  * Prints the contents of a thread context. Used for debugging.
  * @param context the context to print the contents of.
@@ -69,6 +143,13 @@ void context_print(struct thread_context * context);
  */
 void context_set_mode(struct thread_context * context, enum context_processor_mode mode);
 
+/**
+ * Gets the processor mode field of a context.
+ * @param context the context.
+ * @return the processor mode of the context.
+ */
+enum context_processor_mode context_get_mode(struct thread_context * context);
+
 /**
  * Sets the program counter register of a thread context.
  * @param context the context to set the register in.
@@ -76,6 +157,13 @@ void context_set_mode(struct thread_context * context, enum context_processor_mo
  */
 void context_set_pc(struct thread_context * context, void * pc);
 
+/**
+ * Gets the program counter register of a thread context.
+ * @param context the context to get the register from.
+ * @return the value of the PC register.
+ */
+void * context_get_pc(struct thread_context * context);
+
 /**
  * Sets the stack pointer of a thread context.
  * @param context the context to set the register in.
@@ -83,6 +171,27 @@ void context_set_pc(struct thread_context * context, void * pc);
  */
 void context_set_sp(struct thread_context * context, void * sp);
 
+/**
+ * Gets the stack pointer of a thread context.
+ * @param context the context to get the register from.
+ * @return the value of the stack pointer register.
+ */
+void * context_get_sp(struct thread_context * context);
+
+/**
+ * Gets the return address register of a thread context.
+ * @param context the context to get the register from.
+ * @return the value of the link register.
+ */
+void * context_get_lr(struct thread_context * context);
+
+/**
+ * Sets the thread ID register, a register which user-mode code can read but
+ * not modify, for the thread that is about to run.
+ * @param tid the TID of the thread.
+ */
+void context_set_thread_id(tid_t tid);
+
 /** @} */
 
 #endif
@@ -0,0 +1,31 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_CYCLES_H
+#define MORDAX_CYCLES_H
+
+#include "api/types.h"
+
+/**
+ * @defgroup cycles Cycle Counter
+ * @{
+ */
+
+/**
+ * Resets and starts the cycle counter of the current processor.
+ */
+void cycles_initialize(void);
+
+/**
+ * Reads the cycle counter of the current processor. The counter is 32 bits
+ * wide and wraps around, so only differences between readings taken less than
+ * a wrap-around period apart are meaningful.
+ * @return the current value of the cycle counter.
+ */
+uint32_t cycles_read(void);
+
+/** @} */
+
+#endif
+
@@ -3,39 +3,134 @@
 // Report bugs and issues on <http://github.com/skordal/mordax/issues>
 
 #include "debug.h"
+#include "scheduler.h"
+#include "utils.h"
 #include "api/types.h"
 
 #include <stdarg.h>
 #include <stdbool.h>
 
+// Mask used to get the index of a log position in the log buffer:
+#define LOG_BUFFER_MASK	(CONFIG_LOG_BUFFER_SIZE - 1)
+
 static struct debug_driver * driver;
 
+// The kernel log. Bytes are only added to the log while holding the kernel
+// lock, but the log is drained without it, so the positions are updated only
+// after the bytes they cover have been written. The positions only increase
+// and are masked to get the index in the buffer:
+static char log_buffer[CONFIG_LOG_BUFFER_SIZE];
+static volatile uint32_t log_head = 0;	// Position of the next byte to add to the log.
+static volatile uint32_t log_tail = 0;	// Position of the next byte to write to the terminal.
+static volatile uint32_t draining = 0;	// Set while a processor is draining the log.
+
+// Whether writing messages to the debug terminal is deferred to debug_drain:
+static bool deferred = false;
+// Whether the next byte added to the log starts a new line:
+static bool line_start = true;
+// Log level of the message currently being printed:
+static unsigned int current_level;
+
 #ifdef CONFIG_EARLY_DEBUG
 // Prints a character to the debug terminal, used before a driver has been set
 // by debug_set_output_driver:
 extern void early_putc(char c);
 #endif
 
-// Prints a character to the debug terminal:
+// Prints a formatted string to the kernel log:
+static void debug_vprintf(unsigned int level, const char * format, va_list arguments);
+// Prints a character to the kernel log:
 static void debug_putc(char c);
-// Prints a signed decimal to the debug terminal:
+// Prints a signed decimal to the kernel log:
 static void debug_putd(int n);
-// Prints a hexadecimal number to the debug terminal:
+// Prints an unsigned decimal with at least the specified number of digits to the kernel log:
+static void debug_putu(uint32_t n, unsigned int digits);
+// Prints a hexadecimal number to the kernel log:
 static void debug_puth(uint32_t n);
-// Prints a string to the debug terminal:
+// Prints a string to the kernel log:
 static void debug_puts(const char * s);
+// Prints the level and timestamp that start a line in the kernel log:
+static void debug_put_prefix(void);
+// Returns true if there is a debug terminal to write to:
+static bool can_output(void);
+// Writes a character to the debug terminal:
+static void output_putc(char c);
+// Writes the pending bytes in the log to the debug terminal:
+static void drain_log(void);
 
 void debug_set_output_driver(struct debug_driver * d)
 {
 	driver = d;
-	// TODO: Add a buffer for storing debug messages
-	// TODO: Flush the buffer to the output device when this function is called
+	debug_drain();
 }
 
 void debug_printf(const char * format, ...)
 {
 	va_list arguments;
 	va_start(arguments, format);
+	debug_vprintf(MORDAX_LOG_INFO, format, arguments);
+	va_end(arguments);
+}
+
+void debug_log(unsigned int level, const char * format, ...)
+{
+	va_list arguments;
+	va_start(arguments, format);
+	debug_vprintf(level, format, arguments);
+	va_end(arguments);
+}
+
+void debug_start_deferred_output(void)
+{
+	deferred = true;
+}
+
+void debug_drain(void)
+{
+	if(!can_output())
+		return;
+	if(!__sync_bool_compare_and_swap(&draining, 0, 1))
+		return;
+
+	drain_log();
+
+	__sync_synchronize();
+	draining = 0;
+}
+
+void debug_flush(void)
+{
+	if(can_output())
+		drain_log();
+}
+
+size_t debug_log_read(uint32_t * position, char * buffer, size_t length)
+{
+	uint32_t start = *position;
+	uint32_t head = log_head;
+
+	// Start at the oldest byte in the log if the position has been overwritten:
+	if(head - start > CONFIG_LOG_BUFFER_SIZE)
+		start = head - CONFIG_LOG_BUFFER_SIZE;
+
+	size_t retval = head - start;
+	if(retval > length)
+		retval = length;
+
+	// The bytes to copy may wrap around the end of the buffer:
+	size_t first = CONFIG_LOG_BUFFER_SIZE - (start & LOG_BUFFER_MASK);
+	if(first > retval)
+		first = retval;
+	memcpy(buffer, log_buffer + (start & LOG_BUFFER_MASK), first);
+	memcpy(buffer + first, log_buffer, retval - first);
+
+	*position = start + retval;
+	return retval;
+}
+
+static void debug_vprintf(unsigned int level, const char * format, va_list arguments)
+{
+	current_level = level;
 
 	for(int i = 0; format[i] != 0; ++i)
 	{
@@ -70,34 +165,28 @@ void debug_printf(const char * format, ...)
 		}
 	}
 
-	va_end(arguments);
+	if(!deferred)
+		debug_drain();
 }
 
 static void debug_putc(char c)
 {
-	if(c == '\n')
-		debug_putc('\r');
-
-	if(driver != 0)
-		driver->putc(c);
-	else {
-#ifdef CONFIG_EARLY_DEBUG
-		early_putc(c);
-#endif
+	if(line_start)
+	{
+		line_start = false;
+		debug_put_prefix();
 	}
+
+	log_buffer[log_head & LOG_BUFFER_MASK] = c;
+	__sync_synchronize();
+	++log_head;
+
+	if(c == '\n')
+		line_start = true;
 }
 
 static void debug_putd(int n)
 {
-	bool leading = true;
-
-	// If the input number is 0, just print 0 and return:
-	if(n == 0)
-	{
-		debug_putc('0');
-		return;
-	}
-
 	// If the number is negative, print a minus sign and convert it to
 	// a positive number:
 	if(n & 0x80000000)
@@ -106,16 +195,24 @@ static void debug_putd(int n)
 		debug_putc('-');
 	}
 
-	for(unsigned int i = 1000000000; i > 0; i /= 10)
+	debug_putu(n, 1);
+}
+
+static void debug_putu(uint32_t n, unsigned int digits)
+{
+	unsigned int i = 1000000000, length = 10;
+
+	// Skip leading zeroes, except for the minimum number of digits:
+	while(i > 1 && n / i == 0 && length > digits)
+	{
+		i /= 10;
+		--length;
+	}
+
+	for(; i > 0; i /= 10)
 	{
-		if(n / i == 0 && !leading)
-			debug_putc('0');
-		else if(n / i != 0)
-		{
-			debug_putc('0' + (n / i));
-			n %= i;
-			leading = false;
-		}
+		debug_putc('0' + (n / i));
+		n %= i;
 	}
 }
 
@@ -136,5 +233,61 @@ static void debug_puts(const char * string)
 			debug_putc(string[i]);
 }
 
+static void debug_put_prefix(void)
+{
+	uint64_t now = scheduler_get_time();
+
+	debug_putc('<');
+	debug_putu(current_level, 1);
+	debug_puts(">[");
+	debug_putu(now / 1000000, 1);
+	debug_putc('.');
+	debug_putu(now % 1000000, 6);
+	debug_puts("] ");
+}
+
+static bool can_output(void)
+{
+#ifdef CONFIG_EARLY_DEBUG
+	return true;
+#else
+	return driver != 0;
+#endif
+}
+
+static void output_putc(char c)
+{
+	if(c == '\n')
+		output_putc('\r');
+
+	if(driver != 0)
+		driver->putc(c);
+	else {
+#ifdef CONFIG_EARLY_DEBUG
+		early_putc(c);
+#endif
+	}
+}
+
+static void drain_log(void)
+{
+	while(log_tail != log_head)
+	{
+		uint32_t tail = log_tail;
+		char c = log_buffer[tail & LOG_BUFFER_MASK];
 
+		// If the byte may have been overwritten while reading it, skip to
+		// the oldest byte that is still in the log:
+		__sync_synchronize();
+		uint32_t head = log_head;
+		if(head - tail >= CONFIG_LOG_BUFFER_SIZE)
+		{
+			log_tail = head - CONFIG_LOG_BUFFER_SIZE + 1;
+			continue;
+		}
+
+		output_putc(c);
+		log_tail = tail + 1;
+	}
+}
 
@@ -7,17 +7,110 @@
 
 #include "drivers/debug/debug.h"
 
+#include "api/log.h"
+
+/**
+ * @defgroup debug Debug Output
+ * Debug messages are written to the kernel log, a ring buffer which is
+ * copied to the debug terminal by the idle thread. Writing a message is
+ * therefore independent of the speed of the debug terminal. If messages are
+ * written faster than the debug terminal can output them, the oldest
+ * messages are overwritten and never written to the terminal.
+ * Until the scheduler is started, messages are written to the debug terminal
+ * immediately.
+ * @{
+ */
+
+#ifndef CONFIG_LOG_BUFFER_SIZE
+#error "kernel log buffer size is not set, define CONFIG_LOG_BUFFER_SIZE with the proper value"
+#endif
+
+#if (CONFIG_LOG_BUFFER_SIZE & (CONFIG_LOG_BUFFER_SIZE - 1)) != 0
+#error "kernel log buffer size must be a power of two"
+#endif
+
+#ifndef CONFIG_LOG_LEVEL
+#define CONFIG_LOG_LEVEL	MORDAX_LOG_DEBUG
+#endif
+
+/**
+ * Prints a message to the kernel log if its log level is enabled by
+ * `CONFIG_LOG_LEVEL`. Messages with a disabled log level are removed by
+ * the compiler, including the formatting of the message and the evaluation
+ * of its arguments, but the arguments are still type checked.
+ * @param level the log level of the message.
+ */
+#define log_message(level, ...) \
+	do { \
+		if((level) <= CONFIG_LOG_LEVEL) \
+			debug_log((level), __VA_ARGS__); \
+	} while(0)
+
+/** Prints an error message to the kernel log. */
+#define log_error(...)		log_message(MORDAX_LOG_ERROR, __VA_ARGS__)
+/** Prints a warning to the kernel log. */
+#define log_warning(...)	log_message(MORDAX_LOG_WARNING, __VA_ARGS__)
+/** Prints an informational message to the kernel log. */
+#define log_info(...)		log_message(MORDAX_LOG_INFO, __VA_ARGS__)
+/** Prints a debugging message to the kernel log. */
+#define log_debug(...)		log_message(MORDAX_LOG_DEBUG, __VA_ARGS__)
+
 /**
  * Sets the debug driver to use for outputting debug messages to a terminal.
+ * Messages already in the kernel log are written to the new terminal.
  * @param driver the driver to use.
  */
 void debug_set_output_driver(struct debug_driver * driver);
 
 /**
- * Prints a formatted string to the debug terminal.
+ * Prints a formatted string to the kernel log, using the info log level.
+ * Unlike the log macros, this function is not affected by `CONFIG_LOG_LEVEL`,
+ * and is used for output that is explicitly requested, such as register dumps.
  * @param format string specifying the format of the output string.
  */
 void debug_printf(const char * format, ...);
 
+/**
+ * Prints a formatted string to the kernel log. Use the log macros instead
+ * of calling this function directly.
+ * @param level the log level of the message.
+ * @param format string specifying the format of the output string.
+ */
+void debug_log(unsigned int level, const char * format, ...);
+
+/**
+ * Starts deferred output. After this has been called, messages are only
+ * written to the debug terminal when calling debug_drain().
+ */
+void debug_start_deferred_output(void);
+
+/**
+ * Writes the messages in the kernel log that have not yet been written to
+ * the debug terminal. This function may be called without holding the kernel
+ * lock; if another processor is already draining the log it returns immediately.
+ */
+void debug_drain(void);
+
+/**
+ * Writes all pending messages in the kernel log to the debug terminal,
+ * regardless of whether another processor is draining the log. Used when
+ * the kernel cannot continue.
+ */
+void debug_flush(void);
+
+/**
+ * Copies messages from the kernel log.
+ * @param position position in the log to start copying from. This is updated
+ *                 to the position after the last copied byte. If the position
+ *                 has been overwritten, copying starts at the oldest byte in
+ *                 the log. Start with 0 to read the entire log.
+ * @param buffer buffer to copy the messages into.
+ * @param length length of the buffer.
+ * @return the number of bytes copied.
+ */
+size_t debug_log_read(uint32_t * position, char * buffer, size_t length);
+
+/** @} */
+
 #endif
 
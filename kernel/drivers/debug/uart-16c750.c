@@ -16,7 +16,7 @@ bool uart_16c750_initialize(struct dt_node * device_node)
 	uint32_t memory_info[2];
 	if(!dt_get_array32_property(device_node, "reg", memory_info, 2))
 	{
-		debug_printf("Error: debug uart node \"%s\" has no \"reg\" property\n",
+		log_error("Error: debug uart node \"%s\" has no \"reg\" property\n",
 			device_node->name);
 		return false;
 	}
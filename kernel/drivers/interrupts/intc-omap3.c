@@ -6,6 +6,7 @@
 
 #include <debug.h>
 #include <mmu.h>
+#include <trace.h>
 
 static volatile uint32_t * memory;
 
@@ -19,7 +20,7 @@ bool intc_omap3_initialize(struct dt_node * device_node)
 	uint32_t memory_info[2];
 	if(!dt_get_array32_property(device_node, "reg", memory_info, 2))
 	{
-		debug_printf("Error: interrupt controller node \"%s\" has no \"reg\" property!\n",
+		log_error("Error: interrupt controller node \"%s\" has no \"reg\" property!\n",
 			device_node->name);
 		return false;
 	}
@@ -55,7 +56,9 @@ void intc_omap3_handle_irq(struct thread_context * context)
 	unsigned active_irq = memory[INTC_OMAP3_SIR_IRQ] & INTC_OMAP3_SIR_IRQ_ACTIVEIRQ_MASK;
 
 	// Call the IRQ handler:
+	trace_event(MORDAX_TRACE_IRQ_ENTRY, active_irq, 0);
 	irq_handlers[active_irq].function(context, active_irq, irq_handlers[active_irq].data_ptr);
+	trace_event(MORDAX_TRACE_IRQ_EXIT, active_irq, 0);
 
 	// Reset interrupt generation:
 	asm volatile("dsb\n\t");
@@ -39,7 +39,7 @@ struct intc_driver * intc_driver_instantiate(struct dt_node * device_node)
 	{
 		if(str_equals(drivers[i].compatible, compatible))
 		{
-			debug_printf("Interrupt controller driver: %s\n", compatible);
+			log_info("Interrupt controller driver: %s\n", compatible);
 			drivers[i].driver->initialize(device_node);
 			return drivers[i].driver;
 		}
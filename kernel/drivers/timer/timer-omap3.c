@@ -23,7 +23,7 @@ bool timer_omap3_initialize(struct dt_node * device_node)
 	uint32_t memory_info[2];
 	if(!dt_get_array32_property(device_node, "reg", memory_info, 2))
 	{
-		debug_printf("Error: timer node \"%s\" has no \"reg\" property\n",
+		log_error("Error: timer node \"%s\" has no \"reg\" property\n",
 			device_node->name);
 		return false;
 	}
@@ -40,7 +40,7 @@ bool timer_omap3_initialize(struct dt_node * device_node)
 	uint32_t irq_number;
 	if(!dt_get_array32_property(device_node, "interrupts", &irq_number, 1))
 	{
-		debug_printf("Error: timer noe \"%s\" has no \"interrupts\" property\n",
+		log_error("Error: timer noe \"%s\" has no \"interrupts\" property\n",
 			device_node->name);
 	}
 
@@ -66,6 +66,8 @@ void timer_omap3_start(void)
 	// Set up the interval value:
 	memory[TIMER_OMAP3_TLDR] = -interval;
 	memory[TIMER_OMAP3_TTGR] = 1; // triggers a counter reload
+	// Discard any overflow of the previous interval:
+	memory[TIMER_OMAP3_TISR] = 0x7;
 
 	// Set the timer mode to autoreload the counter value on overflow:
 	memory[TIMER_OMAP3_TCLR] = 1 << TIMER_OMAP3_TRG | 1 << TIMER_OMAP3_AR;
@@ -81,10 +83,25 @@ void timer_omap3_stop(void)
 	memory[TIMER_OMAP3_TCLR] &= ~(1 << TIMER_OMAP3_ST);
 }
 
+unsigned int timer_omap3_get_elapsed(void)
+{
+	uint32_t elapsed = memory[TIMER_OMAP3_TCRR] + interval;
+
+	// If the counter has overflowed but the interrupt has not been handled
+	// yet, a full interval has passed in addition to the counter value:
+	if(memory[TIMER_OMAP3_TISR] & (1 << TIMER_OMAP3_OVF_IT_FLAG))
+		elapsed = memory[TIMER_OMAP3_TCRR] + 2 * interval;
+
+	return elapsed / (TIMER_OMAP3_FCLK / 1000000);
+}
+
 static void timer_omap3_irq_handler(struct thread_context * context, unsigned irq, void * data_ptr)
 {
+	// Acknowledge the interrupt before running the callback, as the
+	// callback already accounts for the elapsed interval and would see it
+	// twice in the elapsed time if the overflow flag was still set:
+	memory[TIMER_OMAP3_TISR] = 0x7;
 	if(callback != 0)
 		callback();
-	memory[TIMER_OMAP3_TISR] = 0x7;
 }
 
@@ -16,6 +16,7 @@
 #define TIMER_OMAP3_TISR	(0x18 >> 2)
 #define TIMER_OMAP3_TIER	(0x1c >> 2)
 #define TIMER_OMAP3_TCLR	(0x24 >> 2)
+#define TIMER_OMAP3_TCRR	(0x28 >> 2)
 #define TIMER_OMAP3_TLDR	(0x2c >> 2)
 #define TIMER_OMAP3_TTGR	(0x30 >> 2)
 
@@ -43,6 +44,7 @@ void timer_omap3_set_interval(unsigned int interval);
 void timer_omap3_set_callback(timer_callback_func callback);
 void timer_omap3_start(void);
 void timer_omap3_stop(void);
+unsigned int timer_omap3_get_elapsed(void);
 
 #endif
 
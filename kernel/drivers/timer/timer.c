@@ -20,7 +20,8 @@ struct timer_driver timer_omap3_driver =
 	.set_interval = timer_omap3_set_interval,
 	.set_callback = timer_omap3_set_callback,
 	.start = timer_omap3_start,
-	.stop = timer_omap3_stop
+	.stop = timer_omap3_stop,
+	.get_elapsed = timer_omap3_get_elapsed
 };
 
 static struct timer_driver_list_entry drivers[] =
@@ -37,7 +38,7 @@ struct timer_driver * timer_driver_instantiate(struct dt_node * device_node)
 	{
 		if(str_equals(drivers[i].compatible, compatible))
 		{
-			debug_printf("Timer driver: %s\n", compatible);
+			log_info("Timer driver: %s\n", compatible);
 			drivers[i].driver->initialize(device_node);
 			return drivers[i].driver;
 		}
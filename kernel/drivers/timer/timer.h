@@ -19,14 +19,21 @@ typedef void (*timer_driver_set_interval_func)(unsigned int interval);
 typedef void (*timer_driver_set_callback_func)(timer_callback_func callback);
 /** Function type for starting and stopping the timer. */
 typedef void (*timer_driver_startstop_func)(void);
-
-/** Timer driver structure. */
+/** Function type for getting the time elapsed in the current interval, in microseconds. */
+typedef unsigned int (*timer_driver_get_elapsed_func)(void);
+
+/**
+ * Timer driver structure. The timer runs periodically with the interval set
+ * by `set_interval`; calling `start` while the timer is running restarts the
+ * current interval, which is used to reprogram the timer.
+ */
 struct timer_driver
 {
 	timer_driver_init_func initialize;
 	timer_driver_set_interval_func set_interval;
 	timer_driver_set_callback_func set_callback;
 	timer_driver_startstop_func start, stop;
+	timer_driver_get_elapsed_func get_elapsed;
 };
 
 struct timer_driver * timer_driver_instantiate(struct dt_node * device_node);
@@ -12,8 +12,12 @@
 #define FDT_BEGIN_NODE	1
 #define FDT_END_NODE	2
 #define FDT_PROP	3
+#define FDT_NOP		4
 #define FDT_END		9
 
+// Marks the absence of a node while indexing the device tree:
+#define NO_NODE		((uint32_t) -1)
+
 // Flattened device tree header fields:
 struct fdt
 {
@@ -25,82 +29,102 @@ struct fdt
 	be32 version;
 };
 
-// Function for recursively searching for a node with a specific compatible string:
-static struct dt_node * dt_get_node_by_compatible_from(struct dt * dt, struct dt_node * root,
-	const char * compatible, int index, int * cur_index);
+// Entry in the table of compatible strings. The nodes listing the string are
+// stored in the compatible node array, in the order they appear in the tree:
+struct dt_compatible
+{
+	const char * string;
+	uint32_t hash;
+	uint32_t first, count;
+};
+
+// Indexes the nodes in the structure block, returning false if the structure
+// block is not valid:
+static bool dt_index_nodes(struct dt * dt, const be32 * token, const char * strings,
+	uint32_t * num_phandles, uint32_t * num_compatible);
+
+// Builds the hash tables used for looking up nodes:
+static void dt_build_path_table(struct dt * dt);
+static void dt_build_phandle_table(struct dt * dt, uint32_t num_phandles);
+static void dt_build_compatible_table(struct dt * dt, uint32_t num_compatible);
+
+// Finds the entry for a compatible string, or the empty entry where it belongs:
+static struct dt_compatible * dt_find_compatible(struct dt * dt, const char * compatible, uint32_t hash);
+
+// Allocates a hash table with room for the specified number of entries:
+static void * dt_allocate_table(uint32_t entries, size_t entry_size, uint32_t * mask);
+
+// Checks if the path of a node equals the first `length` characters of a path:
+static bool dt_path_equals(struct dt_node * node, const char * path, size_t length);
+
+// Finds a property in a node, returning a pointer to its value:
+static const void * dt_find_property(struct dt_node * node, const char * name, uint32_t * length);
 
 // Prints a device tree node and all its properties and child nodes:
 static void dt_print_node(struct dt_node * node, int indentation_level);
 
-// Parses the FDT node pointed to by the first argument, storing the result
-// in ret and returning the number of 32-bit words consumed:
-static uint32_t dt_parse_node(struct fdt *, be32 * fdt_node, struct dt_node ** ret);
-
-// Parses a property from the property list for a node and returns the number
-// of 32-bit words consumed:
-static uint32_t dt_parse_property(struct fdt *, be32 * prop, struct dt_property ** p);
+// Continues a 32-bit FNV-1a hash with the first `length` characters of a string:
+static uint32_t hash_string(uint32_t hash, const char * string, size_t length);
 
-// Gets a pointer to a string in the string table:
-static const char * dt_get_string(struct fdt * fdt, uint32_t offset);
+// Initial value of an FNV-1a hash:
+#define HASH_INITIAL	2166136261u
 
 struct dt * dt_parse(struct fdt * fdt)
 {
 	// Check for a valid flattened device tree:
-	if(be2le32(*((be32 *) fdt)) != FDT_MAGIC)
+	if(be2le32(fdt->magic) != FDT_MAGIC)
 		return 0;
 
 	struct dt * retval = mm_allocate(sizeof(struct dt), MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
-	uint32_t * structure_block = (uint32_t *) ((uint32_t) fdt + be2le32(fdt->struct_offset));
+	memclr(retval, sizeof(struct dt));
+
+	const be32 * structure_block = (const be32 *) ((uint32_t) fdt + be2le32(fdt->struct_offset));
+	const char * strings_block = (const char *) ((uint32_t) fdt + be2le32(fdt->strings_offset));
+
+	uint32_t num_phandles = 0, num_compatible = 0;
+	if(!dt_index_nodes(retval, structure_block, strings_block, &num_phandles, &num_compatible))
+	{
+		mm_free(retval->root);
+		mm_free(retval);
+		return 0;
+	}
 
-	// Parse the root node:
-	struct dt_node * root_node = 0;
-	dt_parse_node(fdt, structure_block, &root_node);
+	dt_build_path_table(retval);
+	dt_build_phandle_table(retval, num_phandles);
+	dt_build_compatible_table(retval, num_compatible);
 
-	retval->root = root_node;
 	return retval;
 }
 
 struct dt_node * dt_get_node_by_path(struct dt * dt, const char * path)
 {
-	if(path[0] != '/' || dt == 0)
-		return 0;	
-	else if(path[0] == '/' && path[1] == 0)
+	if(dt == 0 || path[0] != '/')
+		return 0;
+	else if(path[1] == 0)
 		return dt->root;
 
-	char * nextpath = mm_allocate(strlen(path + 1) + 1, MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
-	char * free_nextpath = nextpath;
-	strcpy(nextpath, path + 1);
-
-	struct dt_node * retval = dt->root;
-	char * next_node_name = strsep(&nextpath, '/');
-	do {
-		retval = dt_get_subnode(retval, next_node_name);
-		next_node_name = strsep(&nextpath, '/');
-	} while(nextpath != 0);
+	size_t length = strlen(path);
+	uint32_t hash = hash_string(HASH_INITIAL, path, length);
+	for(uint32_t i = hash & dt->path_mask; dt->path_table[i] != 0; i = (i + 1) & dt->path_mask)
+	{
+		struct dt_node * node = dt->path_table[i];
+		if(node->path_hash == hash && dt_path_equals(node, path, length))
+			return node;
+	}
 
-	mm_free(free_nextpath);
-	return retval;
+	return 0;
 }
 
 struct dt_node * dt_get_node_by_phandle(struct dt * dt, dt_phandle phandle)
 {
-	struct dt_node * retval = dt->root;
-	do {
-		dt_phandle current_phandle = 0;
-
-		if(dt_property_exists(retval, "linux,phandle"))
-			current_phandle = dt_get_phandle_property(retval, "linux,phandle");
-		else if(dt_property_exists(retval, "phandle"))
-			current_phandle = dt_get_phandle_property(retval, "phandle");
-
-		if(current_phandle == phandle)
-			return retval;
+	if(phandle == 0)
+		return 0;
 
-		if(retval->next)
-			retval = retval->next;
-		else
-			retval = retval->children;
-	} while(retval != 0);
+	for(uint32_t i = phandle & dt->phandle_mask; dt->phandle_table[i] != 0; i = (i + 1) & dt->phandle_mask)
+	{
+		if(dt->phandle_table[i]->phandle == phandle)
+			return dt->phandle_table[i];
+	}
 
 	return 0;
 }
@@ -121,48 +145,48 @@ struct dt_node * dt_get_node_by_alias(struct dt * dt, const char * alias)
 
 struct dt_node * dt_get_node_by_compatible(struct dt * dt, const char * compatible, int index)
 {
-	int counter = 0;
-	return dt_get_node_by_compatible_from(dt, dt->root, compatible, index, &counter);
+	struct dt_compatible * entry = dt_find_compatible(dt, compatible,
+		hash_string(HASH_INITIAL, compatible, strlen(compatible)));
+	if(entry->string == 0 || index < 0 || (uint32_t) index >= entry->count)
+		return 0;
+
+	return dt->compatible_nodes[entry->first + index];
 }
 
 struct dt_node * dt_get_subnode(struct dt_node * node, const char * name)
 {
-	for(struct dt_node * child = node->children; child != 0; child = child->next)
+	// The children of a node follow it in the node array, each followed by
+	// its own descendants:
+	for(struct dt_node * child = node + 1; child <= node + node->descendants;
+		child += child->descendants + 1)
+	{
 		if(str_equals(child->name, name))
 			return child;
+	}
+
 	return 0;
 }
 
 bool dt_property_exists(struct dt_node * node, const char * name)
 {
-	for(struct dt_property * current = node->properties; current != 0; current = current->next)
-		if(str_equals(current->name, name))
-			return true;
-	return false;
+	return dt_find_property(node, name, 0) != 0;
 }
 
 const char * dt_get_string_property(struct dt_node * node, const char * name)
 {
-	for(struct dt_property * current = node->properties; current != 0; current = current->next)
-		if(str_equals(current->name, name))
-			return (const char *) current->value;
-	return 0;
+	return dt_find_property(node, name, 0);
 }
 
 bool dt_get_array32_property(struct dt_node * node, const char * name, uint32_t * out, size_t length)
 {
-	for(struct dt_property * current = node->properties; current != 0; current = current->next)
-	{
-		if(str_equals(current->name, name))
-		{
-			be32 * values = (be32 *) current->value;
-			for(unsigned i = 0; i < length; ++i)
-				out[i] = be2le32(values[i]);
-			return true;
-		}
-	}
-
-	return false;
+	uint32_t value_length;
+	const be32 * values = dt_find_property(node, name, &value_length);
+	if(values == 0 || value_length < length * sizeof(uint32_t))
+		return false;
+
+	for(unsigned i = 0; i < length; ++i)
+		out[i] = be2le32(values[i]);
+	return true;
 }
 
 dt_phandle dt_get_phandle_property(struct dt_node * node, const char * name)
@@ -177,149 +201,302 @@ void dt_print(struct dt * dt)
 	dt_print_node(dt->root, 0);
 }
 
-static void dt_print_node(struct dt_node * node, int indentation_level)
+static bool dt_index_nodes(struct dt * dt, const be32 * token, const char * strings,
+	uint32_t * num_phandles, uint32_t * num_compatible)
 {
-	for(int i = 0; i < indentation_level; ++i)
-		debug_printf("\t");
-	debug_printf("Node name: %s\n", node->name);
+	uint32_t nodes_size = 0, parent = NO_NODE;
+	struct dt_node * nodes = 0;
 
-	for(struct dt_property * property = node->properties; property != 0; property = property->next)
+	// The structure block is walked once, adding a node to the node array
+	// for each node in the tree:
+	while(true)
 	{
-		for(int i = 0; i < indentation_level; ++i)
-			debug_printf("\t");
-		debug_printf("\t%s\n", property->name);
+		switch(be2le32(*token))
+		{
+			case FDT_BEGIN_NODE:
+			{
+				// There can only be one root node:
+				if(parent == NO_NODE && dt->num_nodes > 0)
+					return false;
+
+				if(dt->num_nodes == nodes_size)
+				{
+					// Nodes refer to each other using distances in the array,
+					// so the array can be moved when it is expanded:
+					uint32_t new_size = nodes_size == 0 ? 32 : nodes_size * 2;
+					struct dt_node * new_nodes = mm_allocate(new_size * sizeof(struct dt_node),
+						MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
+					memcpy(new_nodes, nodes, nodes_size * sizeof(struct dt_node));
+					mm_free(nodes);
+					nodes = new_nodes;
+					nodes_size = new_size;
+					dt->root = nodes;
+				}
+
+				struct dt_node * node = &nodes[dt->num_nodes];
+				memclr(node, sizeof(struct dt_node));
+				node->name = (const char *) (token + 1);
+				node->strings = strings;
+
+				// The path of a node is the path of its parent followed by
+				// the name of the node, separated by a slash unless the parent
+				// is the root node:
+				size_t name_length = strlen(node->name);
+				if(parent == NO_NODE)
+					node->path_hash = hash_string(HASH_INITIAL, "/", 1);
+				else {
+					node->parent = dt->num_nodes - parent;
+					node->path_hash = nodes[parent].path_hash;
+					if(parent != 0)
+						node->path_hash = hash_string(node->path_hash, "/", 1);
+					node->path_hash = hash_string(node->path_hash, node->name, name_length);
+				}
+
+				token += 1 + ((name_length + 4) >> 2);
+				node->properties = token;
+				parent = dt->num_nodes++;
+				break;
+			}
+			case FDT_END_NODE:
+				if(parent == NO_NODE)
+					return false;
+
+				nodes[parent].descendants = dt->num_nodes - parent - 1;
+				parent = nodes[parent].parent == 0 ? NO_NODE : parent - nodes[parent].parent;
+				++token;
+				break;
+			case FDT_PROP:
+			{
+				if(parent == NO_NODE)
+					return false;
+
+				uint32_t length = be2le32(token[1]);
+				const char * name = strings + be2le32(token[2]);
+				struct dt_node * node = &nodes[parent];
+
+				if((str_equals(name, "phandle") || str_equals(name, "linux,phandle")) && length >= 4)
+				{
+					if(node->phandle == 0)
+						++(*num_phandles);
+					node->phandle = be2le32(token[3]);
+				} else if(str_equals(name, "compatible"))
+				{
+					// Only strings terminated within the property are used:
+					const char * compatible = (const char *) (token + 3);
+					node->compatible = compatible;
+					node->compatible_length = 0;
+					for(uint32_t i = 0; i < length; ++i)
+					{
+						if(compatible[i] == 0)
+						{
+							node->compatible_length = i + 1;
+							++(*num_compatible);
+						}
+					}
+				}
+
+				token += 3 + ((length + 3) >> 2);
+				break;
+			}
+			case FDT_NOP:
+				++token;
+				break;
+			case FDT_END:
+				if(dt->num_nodes == 0 || parent != NO_NODE)
+					return false;
+
+				// Move the nodes to an array of the exact size:
+				dt->root = mm_allocate(dt->num_nodes * sizeof(struct dt_node), MM_DEFAULT_ALIGNMENT,
+					MM_MEM_NORMAL);
+				memcpy(dt->root, nodes, dt->num_nodes * sizeof(struct dt_node));
+				mm_free(nodes);
+				return true;
+			default:
+				return false;
+		}
 	}
+}
 
-	for(struct dt_node * child = node->children; child != 0; child = child->next)
-		dt_print_node(child, indentation_level + 1);
+static void dt_build_path_table(struct dt * dt)
+{
+	dt->path_table = dt_allocate_table(dt->num_nodes, sizeof(struct dt_node *), &dt->path_mask);
+	for(uint32_t n = 0; n < dt->num_nodes; ++n)
+	{
+		uint32_t i = dt->root[n].path_hash & dt->path_mask;
+		while(dt->path_table[i] != 0)
+			i = (i + 1) & dt->path_mask;
+		dt->path_table[i] = &dt->root[n];
+	}
 }
 
-static struct dt_node * dt_get_node_by_compatible_from(struct dt * dt, struct dt_node * root,
-	const char * compatible, int index, int * cur_index)
+static void dt_build_phandle_table(struct dt * dt, uint32_t num_phandles)
 {
-	struct dt_node * retval = 0;
-	for(struct dt_node * current = root; current != 0; current = current->next)
+	dt->phandle_table = dt_allocate_table(num_phandles, sizeof(struct dt_node *), &dt->phandle_mask);
+	for(uint32_t n = 0; n < dt->num_nodes; ++n)
 	{
-		if(dt_property_exists(current, "compatible"))
+		if(dt->root[n].phandle == 0)
+			continue;
+
+		uint32_t i = dt->root[n].phandle & dt->phandle_mask;
+		while(dt->phandle_table[i] != 0)
+			i = (i + 1) & dt->phandle_mask;
+		dt->phandle_table[i] = &dt->root[n];
+	}
+}
+
+static void dt_build_compatible_table(struct dt * dt, uint32_t num_compatible)
+{
+	dt->compatible_table = dt_allocate_table(num_compatible, sizeof(struct dt_compatible),
+		&dt->compatible_mask);
+	dt->compatible_nodes = mm_allocate((num_compatible > 0 ? num_compatible : 1) * sizeof(struct dt_node *),
+		MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
+
+	// The table is filled in twice; first to count the nodes listing each
+	// string, and then, after assigning each string its part of the node
+	// array, to fill in the nodes:
+	for(int pass = 0; pass < 2; ++pass)
+	{
+		for(uint32_t n = 0; n < dt->num_nodes; ++n)
 		{
-			const char * v = dt_get_string_property(current, "compatible");
-			if(str_equals(v, compatible))
+			struct dt_node * node = &dt->root[n];
+			for(uint32_t i = 0; i < node->compatible_length;)
 			{
-				if(*cur_index == index)
+				const char * string = node->compatible + i;
+				size_t length = strlen(string);
+				uint32_t hash = hash_string(HASH_INITIAL, string, length);
+
+				struct dt_compatible * entry = dt_find_compatible(dt, string, hash);
+				if(pass == 0)
 				{
-					retval = current;
-					break;
+					entry->string = string;
+					entry->hash = hash;
 				} else
-					++(*cur_index);
+					dt->compatible_nodes[entry->first + entry->count] = node;
+				++entry->count;
+
+				i += length + 1;
 			}
 		}
 
-		// Check any children of the current node:
-		if(current->children)
+		if(pass == 0)
 		{
-			retval = dt_get_node_by_compatible_from(dt, current->children,
-				compatible, index, cur_index);
-			if(retval != 0)
-				break;
+			uint32_t first = 0;
+			for(uint32_t i = 0; i <= dt->compatible_mask; ++i)
+			{
+				dt->compatible_table[i].first = first;
+				first += dt->compatible_table[i].count;
+				dt->compatible_table[i].count = 0;
+			}
 		}
 	}
-
-	return retval;
 }
 
-static uint32_t dt_parse_node(struct fdt * fdt, be32 * fdt_node, struct dt_node ** ret)
+static struct dt_compatible * dt_find_compatible(struct dt * dt, const char * compatible, uint32_t hash)
 {
-	uint32_t retval = 0;
-	*ret = mm_allocate(sizeof(struct dt_node), MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
-	memclr(*ret, sizeof(struct dt_node));
-
-	if(be2le32(*fdt_node) != FDT_BEGIN_NODE)
+	uint32_t i = hash & dt->compatible_mask;
+	while(dt->compatible_table[i].string != 0 && (dt->compatible_table[i].hash != hash
+		|| !str_equals(dt->compatible_table[i].string, compatible)))
 	{
-		*ret = 0;
-		return 0;
+		i = (i + 1) & dt->compatible_mask;
 	}
 
-	++retval; ++fdt_node;
-	(*ret)->name = mm_allocate(strlen((const char *) fdt_node) + 1,
-		MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
-	strcpy((*ret)->name, (const char *) fdt_node);
+	return &dt->compatible_table[i];
+}
 
-	retval += ((strlen((*ret)->name) + 4) & -4) >> 2;
-	fdt_node += ((strlen((*ret)->name) + 4) & -4) >> 2;
+static void * dt_allocate_table(uint32_t entries, size_t entry_size, uint32_t * mask)
+{
+	// Keep the tables at most half full, so that probing stays short:
+	uint32_t size = 2;
+	while(size < entries * 2)
+		size <<= 1;
+
+	void * retval = mm_allocate(size * entry_size, MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
+	memclr(retval, size * entry_size);
+	*mask = size - 1;
+	return retval;
+}
 
-	// Parse the property list:
-	struct dt_property * last_prop = (*ret)->properties;
-	while(be2le32(*fdt_node) == FDT_PROP)
+static bool dt_path_equals(struct dt_node * node, const char * path, size_t length)
+{
+	// Compare the names of the node and its parents with the path, starting
+	// with the last part of the path:
+	for(; node->parent != 0; node -= node->parent)
 	{
-		struct dt_property * property;
-		uint32_t inc = dt_parse_property(fdt, fdt_node, &property);
-
-		if(last_prop == 0)
-			(*ret)->properties = property;
-		else
-			last_prop->next = property;
-		last_prop = property;
-
-		retval += inc; fdt_node += inc;
+		size_t name_length = strlen(node->name);
+		if(name_length + 1 > length || path[length - name_length - 1] != '/')
+			return false;
+
+		length -= name_length;
+		for(size_t i = 0; i < name_length; ++i)
+			if(path[length + i] != node->name[i])
+				return false;
+		--length;
 	}
 
-	// Parse any child nodes:
-	struct dt_node * last_child = (*ret)->children;
-	while(be2le32(*fdt_node) == FDT_BEGIN_NODE)
+	return length == 0;
+}
+
+static const void * dt_find_property(struct dt_node * node, const char * name, uint32_t * length)
+{
+	const be32 * token = node->properties;
+	while(true)
 	{
-		struct dt_node * child = 0;
-		uint32_t inc = dt_parse_node(fdt, fdt_node, &child);
+		uint32_t type = be2le32(*token);
+		if(type == FDT_NOP)
+		{
+			++token;
+			continue;
+		} else if(type != FDT_PROP)
+			return 0;
 
-		if(last_child == 0)
-			(*ret)->children = child;
-		else
-			last_child->next = child;
-		last_child = child;
+		uint32_t value_length = be2le32(token[1]);
+		if(str_equals(node->strings + be2le32(token[2]), name))
+		{
+			if(length != 0)
+				*length = value_length;
+			return token + 3;
+		}
 
-		retval += inc; fdt_node += inc;
+		token += 3 + ((value_length + 3) >> 2);
 	}
-
-	++retval; ++fdt_node;
-	return retval;
 }
 
-static uint32_t dt_parse_property(struct fdt * fdt, be32 * prop, struct dt_property ** p)
+static void dt_print_node(struct dt_node * node, int indentation_level)
 {
-	uint32_t retval = 0;
+	for(int i = 0; i < indentation_level; ++i)
+		debug_printf("\t");
+	debug_printf("Node name: %s\n", node->name);
 
-	if(be2le32(*prop) != FDT_PROP)
+	for(const be32 * token = node->properties; be2le32(*token) == FDT_PROP || be2le32(*token) == FDT_NOP;)
 	{
-		*p = 0;
-		return 0;
-	}
-
-	*p = mm_allocate(sizeof(struct dt_property), MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
-	memclr(*p, sizeof(struct dt_property));
-
-	// Get the length of the property value:
-	++retval; ++prop;
-	(*p)->value_length = be2le32(*prop);
+		if(be2le32(*token) == FDT_NOP)
+		{
+			++token;
+			continue;
+		}
 
-	// Get the name of the property:
-	++retval; ++prop;
-	(*p)->name = mm_allocate(strlen(dt_get_string(fdt, be2le32(*prop))) + 1, MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
-	strcpy((*p)->name, dt_get_string(fdt, be2le32(*prop)));
+		for(int i = 0; i < indentation_level; ++i)
+			debug_printf("\t");
+		debug_printf("\t%s\n", node->strings + be2le32(token[2]));
+		token += 3 + ((be2le32(token[1]) + 3) >> 2);
+	}
 
-	// Copy out the value of the property:
-	++retval; ++prop;
-	if((*p)->value_length != 0)
+	for(struct dt_node * child = node + 1; child <= node + node->descendants;
+		child += child->descendants + 1)
 	{
-		(*p)->value = mm_allocate((*p)->value_length, MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
-		memcpy((*p)->value, prop, (*p)->value_length);
-		retval += (((*p)->value_length + 3) & -4) >> 2;
+		dt_print_node(child, indentation_level + 1);
 	}
-
-	return retval;
 }
 
-static const char * dt_get_string(struct fdt * fdt, uint32_t offset)
+static uint32_t hash_string(uint32_t hash, const char * string, size_t length)
 {
-	const char * string_section = (void *) ((uint32_t) fdt + be2le32(fdt->strings_offset));
-	return string_section + offset;
+	// 32-bit FNV-1a hash:
+	for(size_t i = 0; i < length; ++i)
+	{
+		hash ^= (uint8_t) string[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
 }
 
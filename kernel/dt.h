@@ -16,34 +16,53 @@
 /** Flattened device tree header type. */
 struct fdt;
 
+/** Entry in the table of compatible strings. */
+struct dt_compatible;
+
+typedef uint32_t dt_phandle;
+
+/**
+ * Device tree. The flattened device tree is kept mapped, and node names,
+ * property names and property values point into it. The nodes are indexed
+ * in an array, in the order they appear in the flattened device tree, and
+ * hash tables are used for looking up nodes by path, phandle and compatible
+ * string.
+ */
 struct dt
 {
-	struct dt_node * root;
-};
+	struct dt_node * root;		// Array of all nodes, starting with the root node.
+	uint32_t num_nodes;
 
-struct dt_node
-{
-	char * name;
-	struct dt_property * properties;
+	struct dt_node ** path_table;	// Nodes by the hash of their paths.
+	uint32_t path_mask;
+
+	struct dt_node ** phandle_table;	// Nodes by phandle.
+	uint32_t phandle_mask;
 
-	struct dt_node * next;
-	struct dt_node * children;
+	struct dt_compatible * compatible_table;	// Compatible strings.
+	uint32_t compatible_mask;
+	struct dt_node ** compatible_nodes;	// Nodes listed for each compatible string.
 };
 
-struct dt_property
+struct dt_node
 {
-	char * name;
-	struct dt_property * next;
+	const char * name;
+	const be32 * properties;	// First token following the node name.
+	const char * strings;		// Strings block containing the property names.
 
-	uint32_t value_length;
-	uint8_t * value;
-};
+	uint32_t parent;		// Distance back to the parent node, 0 for the root node.
+	uint32_t descendants;		// Number of nodes in the subtrees of the node.
+	uint32_t path_hash;		// Hash of the full path of the node.
+	dt_phandle phandle;		// Phandle of the node, or 0 if it has none.
 
-typedef uint32_t dt_phandle;
+	const char * compatible;	// Value of the compatible property, or 0.
+	uint32_t compatible_length;
+};
 
 /**
  * Creates a device tree structure from the flattened device tree passed by
- * U-Boot.
+ * U-Boot. The flattened device tree must stay mapped for as long as the
+ * device tree structure is used.
  * @param fdt the flattened device tree from U-Boot.
  * @return a device tree structure or 0 if an error occured.
  */
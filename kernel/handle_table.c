@@ -0,0 +1,105 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#include "handle_table.h"
+#include "mm.h"
+#include "utils.h"
+
+#include "api/errno.h"
+
+// Marks the end of the free slot list:
+#define NO_FREE_SLOT	((unsigned int) -1)
+
+// Mask used for the generation counter, which is kept below the sign bit
+// of the handle:
+#define GENERATION_MASK	0x7fff
+
+// Doubles the number of slots in a handle table:
+static bool expand(struct handle_table * table);
+
+struct handle_table * handle_table_new(void)
+{
+	struct handle_table * retval = mm_allocate(sizeof(struct handle_table),
+		MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
+	retval->entries = 0;
+	retval->size = 0;
+	retval->next_free = NO_FREE_SLOT;
+	return retval;
+}
+
+void handle_table_free(struct handle_table * table, handle_table_free_func free_func)
+{
+	for(unsigned int i = 0; i < table->size; ++i)
+	{
+		if(table->entries[i].used && free_func != 0)
+			free_func(table->entries[i].data, table->entries[i].tag);
+	}
+
+	mm_free(table->entries);
+	mm_free(table);
+}
+
+int handle_table_insert(struct handle_table * table, void * data, unsigned int tag)
+{
+	if(table->next_free == NO_FREE_SLOT && !expand(table))
+		return -ENOMEM;
+
+	unsigned int index = table->next_free;
+	struct handle_table_entry * entry = &table->entries[index];
+	table->next_free = entry->next_free;
+
+	entry->data = data;
+	entry->tag = tag;
+	entry->used = true;
+
+	return (entry->generation << HANDLE_TABLE_INDEX_BITS) | (index + 1);
+}
+
+void * handle_table_remove(struct handle_table * table, int handle, unsigned int * tag)
+{
+	void * retval = handle_table_get(table, handle, tag);
+	if(retval == 0)
+		return 0;
+
+	unsigned int index = (handle & HANDLE_TABLE_MAX_ENTRIES) - 1;
+	struct handle_table_entry * entry = &table->entries[index];
+
+	// Bump the generation so that the old handle stays invalid when the
+	// slot is reused:
+	entry->generation = (entry->generation + 1) & GENERATION_MASK;
+	entry->used = false;
+	entry->next_free = table->next_free;
+	table->next_free = index;
+
+	return retval;
+}
+
+static bool expand(struct handle_table * table)
+{
+	unsigned int new_size = table->size == 0 ? HANDLE_TABLE_INITIAL_SIZE : table->size * 2;
+	if(new_size > HANDLE_TABLE_MAX_ENTRIES)
+		new_size = HANDLE_TABLE_MAX_ENTRIES;
+	if(new_size <= table->size)
+		return false;
+
+	struct handle_table_entry * entries = mm_allocate(new_size * sizeof(struct handle_table_entry),
+		MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
+	if(entries == 0)
+		return false;
+
+	memcpy(entries, table->entries, table->size * sizeof(struct handle_table_entry));
+	memclr(entries + table->size, (new_size - table->size) * sizeof(struct handle_table_entry));
+
+	// Add the new slots to the free list, lowest index first:
+	for(unsigned int i = new_size; i > table->size; --i)
+	{
+		entries[i - 1].next_free = table->next_free;
+		table->next_free = i - 1;
+	}
+
+	mm_free(table->entries);
+	table->entries = entries;
+	table->size = new_size;
+	return true;
+}
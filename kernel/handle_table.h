@@ -0,0 +1,110 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_HANDLE_TABLE_H
+#define MORDAX_HANDLE_TABLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @defgroup handle_table Handle Table
+ * A handle table maps small integer handles to objects using an array
+ * indexed by the handle, so that looking up a handle takes constant time.
+ * Free slots are kept in a list and reused, and each slot has a generation
+ * counter which is part of the handle, so that handles to objects that have
+ * been removed are not mistaken for handles to newer objects in the same slot.
+ * @{
+ */
+
+/** Number of bits of a handle used for the slot index. */
+#define HANDLE_TABLE_INDEX_BITS		16
+
+/** Maximum number of entries in a handle table. */
+#define HANDLE_TABLE_MAX_ENTRIES	((1 << HANDLE_TABLE_INDEX_BITS) - 1)
+
+/** Initial number of slots in a handle table. */
+#define HANDLE_TABLE_INITIAL_SIZE	8
+
+/** Function type used for freeing the objects in a handle table. */
+typedef void (*handle_table_free_func)(void * data, unsigned int tag);
+
+struct handle_table_entry
+{
+	union {
+		void * data;
+		unsigned int next_free;
+	};
+	uint16_t generation;
+	uint8_t tag;
+	bool used;
+};
+
+struct handle_table
+{
+	struct handle_table_entry * entries;
+	unsigned int size;
+	unsigned int next_free;
+};
+
+/**
+ * Creates a new handle table.
+ * @return the new handle table.
+ */
+struct handle_table * handle_table_new(void) __attribute((malloc));
+
+/**
+ * Frees a handle table.
+ * @param table the handle table to free.
+ * @param free_func function called for each object in the table, or 0.
+ */
+void handle_table_free(struct handle_table * table, handle_table_free_func free_func);
+
+/**
+ * Inserts an object into a handle table.
+ * @param table the handle table.
+ * @param data the object to insert.
+ * @param tag a small number stored with the object, such as the object type.
+ * @return a handle to the object, which is always greater than 0, or a
+ *         negative error code if the table is full.
+ */
+int handle_table_insert(struct handle_table * table, void * data, unsigned int tag);
+
+/**
+ * Looks up an object in a handle table.
+ * @param table the handle table.
+ * @param handle the handle of the object.
+ * @param tag pointer to a variable where the tag of the object is stored,
+ *            if the object is found. May be 0.
+ * @return the object or 0 if the handle is not valid.
+ */
+static inline void * handle_table_get(struct handle_table * table, int handle, unsigned int * tag)
+{
+	unsigned int index = (handle & HANDLE_TABLE_MAX_ENTRIES) - 1;
+	if(handle <= 0 || index >= table->size)
+		return 0;
+
+	struct handle_table_entry * entry = &table->entries[index];
+	if(!entry->used || entry->generation != (handle >> HANDLE_TABLE_INDEX_BITS))
+		return 0;
+
+	if(tag != 0)
+		*tag = entry->tag;
+	return entry->data;
+}
+
+/**
+ * Removes an object from a handle table.
+ * @param table the handle table.
+ * @param handle the handle of the object to remove.
+ * @param tag pointer to a variable where the tag of the object is stored,
+ *            if the object is found. May be 0.
+ * @return the removed object or 0 if the handle is not valid.
+ */
+void * handle_table_remove(struct handle_table * table, int handle, unsigned int * tag);
+
+/** @} */
+
+#endif
+
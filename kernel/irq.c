@@ -7,7 +7,9 @@
 #include "irq.h"
 #include "mm.h"
 #include "scheduler.h"
+#include "smp.h"
 #include "thread.h"
+#include "waitset.h"
 
 #include "api/errno.h"
 #include "drivers/interrupts/intc.h"
@@ -17,7 +19,14 @@ static struct intc_driver * driver = 0;
 // IRQ handler function, called from the assembly interrupt handler:
 void irq_interrupt_handler(struct thread_context * context)
 {
+	spinlock_lock(&kernel_lock);
 	driver->handle_irq(context);
+
+	// Run threads woken up by the interrupt, or by another processor while
+	// this processor was idle, without waiting for the next timer tick:
+	if(scheduler_preemption_pending())
+		scheduler_reschedule();
+	spinlock_unlock(&kernel_lock);
 }
 
 // IRQ handler registered by IRQ objects:
@@ -28,10 +37,13 @@ static void irq_object_handler(struct thread_context * context, unsigned irq, vo
 
 	if(object->listener)
 	{
-		context_set_syscall_retval(context, 0);
-		scheduler_move_thread_to_running(object->listener);
+		context_set_syscall_retval(object->listener->context, 0);
+		scheduler_wake_thread(object->listener, SCHEDULER_BOOST_IRQ);
 		object->listener = 0;
 	}
+
+	// The IRQ is re-enabled by the next wait on the wait set:
+	waitset_notify(object->waitset, MORDAX_WAITSET_READY);
 }
 
 void irq_set_intc_driver(struct intc_driver * d)
@@ -73,6 +85,7 @@ struct irq_object * irq_object_create(unsigned irq)
 		MM_MEM_NORMAL);
 	retval->irq = irq;
 	retval->listener = 0;
+	retval->waitset = 0;
 
 	irq_register(irq, irq_object_handler, retval);
 	return retval;
@@ -86,6 +99,7 @@ void irq_object_destroy(struct irq_object * object)
 		scheduler_move_thread_to_running(object->listener);
 	}
 
+	waitset_unwatch(&object->waitset);
 	irq_disable(object->irq);
 	irq_unregister(object->irq);
 
@@ -9,6 +9,7 @@
 struct intc_driver;
 struct thread;
 struct thread_context;
+struct waitset_entry;
 
 /** IRQ handler function. */
 typedef void (*irq_handler_func)(struct thread_context * context, unsigned irq, void * data_ptr);
@@ -21,6 +22,7 @@ struct irq_object
 {
 	unsigned irq;
 	struct thread * listener;
+	struct waitset_entry * waitset;
 };
 
 /**
@@ -7,8 +7,10 @@
 #include "kernel.h"
 #include "mm.h"
 #include "mmu.h"
+#include "profile.h"
 #include "scheduler.h"
 #include "service.h"
+#include "smp.h"
 
 #include "drivers/debug/debug.h"
 #include "drivers/interrupts/intc.h"
@@ -17,6 +19,9 @@
 // Kernel device tree:
 struct dt * kernel_dt;
 
+// Lock protecting the shared kernel state:
+spinlock_t kernel_lock = SPINLOCK_UNLOCKED;
+
 // Functions exported from target specific code:
 extern void interrupts_initialize(void);
 extern void stacks_initialize(void);
@@ -24,6 +29,7 @@ extern void stacks_initialize(void);
 // Initialization functions:
 static void initialize_debug_uart(struct dt_node * mordax_node);
 static void initialize_intc(struct dt_node * mordax_node);
+static void initialize_profiler(struct dt_node * mordax_node);
 static void initialize_scheduler(struct dt_node * mordax_node);
 
 void kernel_main(physical_ptr * device_tree, size_t dt_size)
@@ -36,39 +42,42 @@ void kernel_main(physical_ptr * device_tree, size_t dt_size)
 	mmu_initialize();
 
 	// Print the debug console header:
-	debug_printf("The Mordax Microkernel v0.1\n");
-	debug_printf("(c) Kristian Klomsten Skordal 2013 <kristian.skordal@gmail.com>\n");
-	debug_printf("Report bugs and issues on <http://github.com/skordal/mordax/issues>\n\n");
+	log_info("The Mordax Microkernel v0.1\n");
+	log_info("(c) Kristian Klomsten Skordal 2013 <kristian.skordal@gmail.com>\n");
+	log_info("Report bugs and issues on <http://github.com/skordal/mordax/issues>\n\n");
 
 	// Remap the interrupt handlers:
-	debug_printf("Installing interrupt handlers... ");
+	log_info("Installing interrupt handlers... ");
 	interrupts_initialize();
-	debug_printf("finished\n");
-
-	// Map and parse the FDT passed from uboot and create a more accessible local version of it:
-	debug_printf("Parsing device tree... ");
-	struct fdt * uboot_fdt = mmu_map(0, device_tree, device_tree, dt_size, MORDAX_TYPE_DATA, MORDAX_PERM_RO_NA);
-	kernel_dt = dt_parse(uboot_fdt);
+	log_info("finished\n");
+
+	// Map the FDT passed from uboot and index it. The FDT stays mapped, as the
+	// device tree functions use it directly:
+	log_info("Indexing device tree... ");
+	uint32_t dt_offset = (uint32_t) device_tree & (CONFIG_PAGE_SIZE - 1);
+	mmu_map(0, (physical_ptr) ((uint32_t) device_tree - dt_offset), (void *) ((uint32_t) device_tree - dt_offset),
+		dt_size + dt_offset, MORDAX_TYPE_DATA, MORDAX_PERM_RO_NA);
+	kernel_dt = dt_parse((struct fdt *) device_tree);
 	if(kernel_dt == 0)
 		kernel_panic("could not parse the device tree");
-	mmu_unmap(0, device_tree, dt_size);
-	debug_printf("finished\n");
+	log_info("finished\n");
 
-	debug_printf("\nHardware: %s (compatible: %s)\n",
+	log_info("\nHardware: %s (compatible: %s)\n",
 		dt_get_string_property(kernel_dt->root, "model"),
 		dt_get_string_property(kernel_dt->root, "compatible"));
 
 	// Set up physical memory management:
-	debug_printf("Memory: ");
+	log_info("Memory: ");
 	struct dt_node * memory_node = dt_get_node_by_path(kernel_dt, "/memory");
 	uint32_t memory_data[2];
 	if(!dt_get_array32_property(memory_node, "reg", memory_data, 2))
 		kernel_panic("the 'memory' node is missing the 'reg' property");
-	debug_printf("%d Mb starting at %x physical\n\n", memory_data[1] >> 20, memory_data[0]);
+	log_info("%d Mb starting at %x physical\n\n", memory_data[1] >> 20, memory_data[0]);
 	mm_add_physical((physical_ptr) memory_data[0], (size_t) memory_data[1], MM_ZONE_NORMAL);
 
 	// Reserve the memory currently in use from being allocated:
 	mm_reserve_physical(&load_address, (uint32_t) kernel_dataspace_end - (uint32_t) &kernel_address);
+	mm_reserve_physical(device_tree, dt_size);
 
 	// Set up required stacks:
 	stacks_initialize();
@@ -84,7 +93,10 @@ void kernel_main(physical_ptr * device_tree, size_t dt_size)
 	// Initialize the interrupt controller driver:
 	initialize_intc(mordax_node);
 
-	debug_printf("Hardware initialization finished.\n\n");
+	// Initialize the sampling profiler:
+	initialize_profiler(mordax_node);
+
+	log_info("Hardware initialization finished.\n\n");
 
 	// Initialize IPC:
 	services_initialize();
@@ -92,7 +104,7 @@ void kernel_main(physical_ptr * device_tree, size_t dt_size)
 	// Initialize the scheduler:
 	initialize_scheduler(mordax_node);
 
-	debug_printf("Kernel initialization finished.\n\n");
+	log_info("Kernel initialization finished.\n\n");
 	while(true) asm volatile("wfi\n\t");
 }
 
@@ -100,11 +112,14 @@ void kernel_panic(const char * message)
 {
 	// Better hope the debugging functions still work :-)
 
-	debug_printf("\n\n\n");
-	debug_printf("*** KERNEL PANIC\n");
-	debug_printf("*** ERROR: %s!\n", message);
-	debug_printf("*** An unrecoverable error has occured. Reset the board and try again.\n");
-	debug_printf("\n\n\n");
+	log_error("\n\n\n");
+	log_error("*** KERNEL PANIC\n");
+	log_error("*** ERROR: %s!\n", message);
+	log_error("*** An unrecoverable error has occured. Reset the board and try again.\n");
+	log_error("\n\n\n");
+
+	// The idle threads will not run again, so write the log to the terminal here:
+	debug_flush();
 
 	while(1) asm volatile("cpsid aif\n\twfi\n\t");
 }
@@ -116,7 +131,7 @@ static void initialize_debug_uart(struct dt_node * mordax_node)
 
 	uart_phandle = dt_get_phandle_property(mordax_node, "debug-interface");
 	if(uart_phandle == 0)
-		debug_printf("Warning: no debug-interface under /mordax in the device tree");
+		log_warning("Warning: no debug-interface under /mordax in the device tree");
 	else {
 		uart_node = dt_get_node_by_phandle(kernel_dt, uart_phandle);
 		debug_set_output_driver(debug_driver_instantiate(uart_node));
@@ -136,6 +151,15 @@ static void initialize_intc(struct dt_node * mordax_node)
 	irq_set_intc_driver(intc_driver_instantiate(intc_node));
 }
 
+static void initialize_profiler(struct dt_node * mordax_node)
+{
+	dt_phandle pmu_phandle = dt_get_phandle_property(mordax_node, "performance-monitor");
+	if(pmu_phandle == 0)
+		log_info("No performance-monitor under /mordax in the device tree, sampling profiler disabled\n");
+	else
+		profile_initialize(dt_get_node_by_phandle(kernel_dt, pmu_phandle));
+}
+
 static void initialize_scheduler(struct dt_node * mordax_node)
 {
 	struct dt_node * timer_node = 0, * chosen_node = dt_get_node_by_path(kernel_dt, "/chosen");
@@ -154,7 +178,7 @@ static void initialize_scheduler(struct dt_node * mordax_node)
 		kernel_panic("could not get start address of the initial process");
 	if(!dt_get_array32_property(chosen_node, "linux,initrd-end", &initproc_end, 1))
 		kernel_panic("could not get end address of the initial process");
-	debug_printf("Initial process at %x-%x physical\n", initproc_start, initproc_end);
+	log_info("Initial process at %x-%x physical\n", initproc_start, initproc_end);
 
 	initproc_size = initproc_end - initproc_start;
 	if(!scheduler_initialize(timer_driver_instantiate(timer_node), (void *) initproc_start, initproc_size))
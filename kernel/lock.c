@@ -7,6 +7,9 @@
 #include "mm.h"
 #include "queue.h"
 #include "scheduler.h"
+#include "trace.h"
+#include "utils.h"
+#include "waitset.h"
 
 #include "api/errno.h"
 
@@ -14,22 +17,57 @@ struct lock
 {
 	struct thread * aquired;
 	struct queue * waiting;
+	struct waitset_entry * waitset;
+
+	uint64_t aquired_time;		// Time the lock was given to the current holder.
+	struct mordax_lock_statistics statistics;
+	struct lock * prev, * next;	// Links in the list of all locks.
 };
 
+// List of all locks, used for finding the most contended locks:
+static struct lock * locks = 0;
+// Identifier of the next lock to be created:
+static uint32_t next_lock_id = 0;
+
 // Function used to release all waiting threads when destroying a lock:
 static void lock_release_waiting(struct thread * t);
+// Gives a lock to a thread:
+static void lock_set_holder(struct lock * l, struct thread * t, uint64_t now);
+// Checks if the first lock statistics entry shows more contention than the second:
+static bool more_contended(const struct mordax_lock_statistics * a, const struct mordax_lock_statistics * b);
 
-struct lock * lock_create(void)
+struct lock * lock_create(pid_t owner)
 {
 	struct lock * retval = mm_allocate(sizeof(struct lock), MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
 	retval->aquired = 0;
 	retval->waiting = queue_new();
+	retval->waitset = 0;
+
+	memclr(&retval->statistics, sizeof(struct mordax_lock_statistics));
+	retval->statistics.id = next_lock_id++;
+	retval->statistics.owner = owner;
+	retval->statistics.holder = -1;
+
+	retval->prev = 0;
+	retval->next = locks;
+	if(locks != 0)
+		locks->prev = retval;
+	locks = retval;
+
 	return retval;
 }
 
 void lock_destroy(struct lock * l)
 {
+	if(l->prev != 0)
+		l->prev->next = l->next;
+	else
+		locks = l->next;
+	if(l->next != 0)
+		l->next->prev = l->prev;
+
 	queue_free(l->waiting, (queue_data_free_func) lock_release_waiting);
+	waitset_unwatch(&l->waitset);
 	mm_free(l);
 }
 
@@ -39,10 +77,14 @@ int lock_aquire(struct lock * l, struct thread * t, bool * blocking)
 	if(l->aquired == t)
 		return -EDEADLK;
 
+	uint64_t now = scheduler_get_time();
 	if(l->aquired == 0)
-		l->aquired = t;
+		lock_set_holder(l, t, now);
 	else {
 		*blocking = true;
+		++l->statistics.contended;
+		t->lock_wait_start = now;
+		trace_event(MORDAX_TRACE_LOCK_BLOCK, 0, l->statistics.id);
 		queue_add_back(l->waiting, t);
 		scheduler_move_thread_to_blocking(t);
 	}
@@ -55,21 +97,91 @@ int lock_release(struct lock * l, struct thread * t)
 	if(l->aquired != t)
 		return -EINVAL;
 
+	uint64_t now = scheduler_get_time();
+	l->statistics.hold_time += now - l->aquired_time;
+
 	struct thread * waiting_thread = 0;
 	if(queue_remove_front(l->waiting, (void **) &waiting_thread))
 	{
-		l->aquired = waiting_thread;
+		uint64_t wait_time = now - waiting_thread->lock_wait_start;
+		l->statistics.wait_time += wait_time;
+		if(wait_time > l->statistics.max_wait_time)
+			l->statistics.max_wait_time = wait_time;
+
+		lock_set_holder(l, waiting_thread, now);
+		trace_event(MORDAX_TRACE_LOCK_WAKE, waiting_thread->parent->pid, waiting_thread->tid);
 		context_set_syscall_retval(waiting_thread->context, 0);
 		scheduler_move_thread_to_running(waiting_thread);
-	} else
+	} else {
 		l->aquired = 0;
+		l->statistics.holder = -1;
+		waitset_notify(l->waitset, MORDAX_WAITSET_READY);
+	}
 
 	return 0;
 }
 
+bool lock_is_free(struct lock * l)
+{
+	return l->aquired == 0;
+}
+
+struct waitset_entry ** lock_get_waitset(struct lock * l)
+{
+	return &l->waitset;
+}
+
+unsigned int lock_get_statistics(struct mordax_lock_statistics * buffer, unsigned int length, pid_t owner)
+{
+	uint64_t now = scheduler_get_time();
+	unsigned int retval = 0;
+
+	// Keep the most contended locks sorted in the buffer, dropping the least
+	// contended entry when the buffer is full:
+	for(struct lock * l = locks; l != 0; l = l->next)
+	{
+		if(owner != -1 && l->statistics.owner != owner)
+			continue;
+
+		struct mordax_lock_statistics entry;
+		memcpy(&entry, &l->statistics, sizeof(struct mordax_lock_statistics));
+		if(l->aquired != 0)
+			entry.hold_time += now - l->aquired_time;
+
+		unsigned int index;
+		if(retval < length)
+			index = retval++;
+		else if(length > 0 && more_contended(&entry, &buffer[length - 1]))
+			index = length - 1;
+		else
+			continue;
+
+		for(; index > 0 && more_contended(&entry, &buffer[index - 1]); --index)
+			memcpy(&buffer[index], &buffer[index - 1], sizeof(struct mordax_lock_statistics));
+		memcpy(&buffer[index], &entry, sizeof(struct mordax_lock_statistics));
+	}
+
+	return retval;
+}
+
 static void lock_release_waiting(struct thread * t)
 {
 	context_set_syscall_retval(t->context, (void *) -EIDRM);
 	scheduler_move_thread_to_running(t);
 }
 
+static void lock_set_holder(struct lock * l, struct thread * t, uint64_t now)
+{
+	l->aquired = t;
+	l->aquired_time = now;
+	l->statistics.holder = t->parent->pid;
+	++l->statistics.acquisitions;
+}
+
+static bool more_contended(const struct mordax_lock_statistics * a, const struct mordax_lock_statistics * b)
+{
+	if(a->contended != b->contended)
+		return a->contended > b->contended;
+	return a->wait_time > b->wait_time;
+}
+
@@ -8,15 +8,22 @@
 #include "thread.h"
 #include "types.h"
 
+#include "api/lock.h"
+
 /**
  * @defgroup lock Lock Support
  * @{
  */
 
 struct lock;
+struct waitset_entry;
 
-/** Creates a new lock. */
-struct lock * lock_create(void);
+/**
+ * Creates a new lock.
+ * @param owner PID of the process creating the lock.
+ * @return the new lock.
+ */
+struct lock * lock_create(pid_t owner);
 
 /**
  * Destroys a lock.
@@ -40,6 +47,31 @@ int lock_aquire(struct lock * l, struct thread * t, bool * blocking);
  */
 int lock_release(struct lock * l, struct thread * t);
 
+/**
+ * Checks if a lock is free.
+ * @param l the lock to check.
+ * @return `true` if the lock is not held by any thread.
+ */
+bool lock_is_free(struct lock * l);
+
+/**
+ * Gets the wait set registration field of a lock, see waitset.h.
+ * @param l the lock.
+ * @return a pointer to the registration field of the lock.
+ */
+struct waitset_entry ** lock_get_waitset(struct lock * l);
+
+/**
+ * Gets the contention statistics for the most contended locks, sorted by the
+ * number of contended acquisitions and then by the total wait time.
+ * @param buffer array to store the statistics in.
+ * @param length number of entries in the array.
+ * @param owner PID of the process to get statistics for the locks of, or -1
+ *              to get statistics for all locks.
+ * @return the number of entries stored.
+ */
+unsigned int lock_get_statistics(struct mordax_lock_statistics * buffer, unsigned int length, pid_t owner);
+
 /** @} */
 
 #endif
@@ -206,7 +206,7 @@ static bool expand_heap(size_t size)
 		size = MINIMUM_EXPAND_SIZE;
 
 	size = (size + CONFIG_PAGE_SIZE - 1) & -CONFIG_PAGE_SIZE;
-	debug_printf("Expanding heap by %d bytes\n", size);
+	log_debug("Expanding heap by %d bytes\n", size);
 
 	// Prepare a new block for the allocated memory, if neccessary:
 	struct memory_block * new_block = kernel_dataspace_end;
@@ -376,7 +376,7 @@ bool mm_allocate_physical(size_t size, struct mm_physical_memory * retval)
 	retval->size = order_blocksize(order);
 	retval->flags = zone->flags;
 
-	return true;
+	return retval->base != 0;
 }
 
 static physical_ptr mm_allocate_order(struct memory_zone * zone, unsigned order)
@@ -394,6 +394,8 @@ static physical_ptr mm_allocate_order(struct memory_zone * zone, unsigned order)
 
 	// If no block was found, split a larger order block:
 	physical_ptr split_block = mm_allocate_order(zone, order + 1);
+	if(split_block == 0)
+		return 0;
 	unsigned split_bits = ((uint32_t) split_block - (uint32_t) zone->start) >> log2(order_blocksize(order));
 
 	// Return the first part of the split block, and set the other as unused:
@@ -475,7 +477,8 @@ void mm_reserve_physical(physical_ptr address, size_t size)
 		return;
 
 	unsigned first_bitnum = ((uint32_t) address - (uint32_t) zone->start) >> log2(CONFIG_PAGE_SIZE);
-	unsigned last_bitnum = (((uint32_t) address - (uint32_t) zone->start) + size) >> log2(CONFIG_PAGE_SIZE);
+	unsigned last_bitnum = (((uint32_t) address - (uint32_t) zone->start) + size + CONFIG_PAGE_SIZE - 1)
+		>> log2(CONFIG_PAGE_SIZE);
 	for(unsigned i = first_bitnum; i < last_bitnum; ++i)
 		mm_reserve_block(zone, 0, i);
 }
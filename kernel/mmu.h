@@ -79,6 +79,21 @@ bool mmu_access_permitted(struct mmu_translation_table * table, const void * add
 void * mmu_map(struct mmu_translation_table * table, physical_ptr physical, void * virtual,
 	size_t size, enum mordax_memory_type type, enum mordax_memory_permissions permissions);
 
+/**
+ * Maps kernel memory into a process. Unlike memory mapped using `mmu_map`,
+ * the memory stays owned by the kernel and is not freed when the mapping or
+ * the translation table is freed.
+ * @param table the translation table to create the mapping in.
+ * @param kernel_virtual page aligned kernel address of the memory to map.
+ * @param virtual virtual address to map the memory to.
+ * @param size size of the mapping to create. This is rounded up to a multiple
+ *             of the page size.
+ * @param type type of memory mapping
+ * @param permissions memory access permissions
+ */
+void * mmu_map_shared(struct mmu_translation_table * table, void * kernel_virtual, void * virtual,
+	size_t size, enum mordax_memory_type type, enum mordax_memory_permissions permissions);
+
 /**
  * Changes the attributes for an interval of virtual memory.
  * @param table the translation table to alter.
@@ -99,13 +114,25 @@ void mmu_change_attributes(struct mmu_translation_table * table, void * virtual,
 void * mmu_map_device(physical_ptr physical, size_t size);
 
 /**
- * Unmaps a section of virtual memory.
+ * Unmaps a section of virtual memory. Physical memory mapped into a process
+ * using `mmu_map` is freed, while memory mapped using `mmu_map_shared` is
+ * left to its owner.
  * @param table the translation table to alter.
  * @param virtual the virtual address to unmap.
  * @param size the length of the mapping to unmap.
  */
 void mmu_unmap(struct mmu_translation_table * table, void * virtual, size_t size);
 
+/**
+ * Checks if any page in a range of virtual memory is mapped.
+ * @param table the translation table to check. Set this to `0` to check the
+ *              kernel translation table.
+ * @param virtual start of the range.
+ * @param size length of the range.
+ * @return `true` if at least one page in the range is mapped, `false` otherwise.
+ */
+bool mmu_is_mapped(struct mmu_translation_table * table, const void * virtual, size_t size);
+
 /**
  * Invalidates the MMU cache for the current translation table.
  */
@@ -118,6 +145,15 @@ void mmu_invalidate(void);
  */
 physical_ptr mmu_virtual_to_physical(void * virtual);
 
+/**
+ * Checks if a page is mapped readable for user-mode code in the current
+ * translation table. Unlike `mmu_access_permitted`, this asks the MMU, so
+ * it can be used to avoid page faults when the kernel reads user memory.
+ * @param virtual an address in the page to check.
+ * @return `true` if user-mode code can read the page.
+ */
+bool mmu_user_readable(const void * virtual);
+
 /**
  * Converts a physical address to a virtual address.
  * @param physical the physical address to convert.
@@ -2,63 +2,78 @@
 // (c) Kristian Klomsten Skordal 2013 <kristian.skordal@gmail.com>
 // Report bugs and issues on <http://github.com/skordal/mordax/issues>
 
+#include <stdint.h>
+
 #include "mm.h"
 #include "number_allocator.h"
-#include "rbtree.h"
+#include "utils.h"
+
+// Number of bits in a bitmap word:
+#define WORD_BITS	32
+
+// Bitmaps are stored with the lowest index in the most significant bit, so
+// that the first zero bit of a word can be found using CLZ:
+#define INDEX_BIT(index)	(0x80000000U >> (index))
 
 struct number_allocator
 {
-	unsigned int next_num;
-	struct rbtree * allocated_nums;
+	// A bit in the top level and middle levels is set if the corresponding
+	// word in the level below is full:
+	uint32_t top;
+	uint32_t middle[WORD_BITS];
+	uint32_t bottom[WORD_BITS * WORD_BITS];
 };
 
+// Gets the index of the first zero bit in a word, which must not be full:
+static inline unsigned int first_zero(uint32_t word)
+{
+	return __builtin_clz(~word);
+}
+
 struct number_allocator * number_allocator_new(void)
 {
-	struct number_allocator * retval = mm_allocate(sizeof(struct number_allocator *),
+	struct number_allocator * retval = mm_allocate(sizeof(struct number_allocator),
 		MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
-	retval->allocated_nums = rbtree_new(0, 0, 0, 0);
-	retval->next_num = 0;
+	memclr(retval, sizeof(struct number_allocator));
 	return retval;
 }
 
 void number_allocator_free(struct number_allocator * alloc)
 {
-	rbtree_free(alloc->allocated_nums);
 	mm_free(alloc);
 }
 
 int number_allocator_allocate_num(struct number_allocator * alloc)
 {
-	if(alloc->next_num < 0)
-		alloc->next_num = 0;
-
-	int retval = ++alloc->next_num;
-	int first_attempt = retval;
+	if(alloc->top == 0xffffffff)
+		return 0;
 
-	if(alloc->next_num < 0)
-		alloc->next_num = 0;
-	if(retval <= 0)
-		retval = ++alloc->next_num;
+	unsigned int m = first_zero(alloc->top);
+	unsigned int b = m * WORD_BITS + first_zero(alloc->middle[m]);
+	unsigned int index = b * WORD_BITS + first_zero(alloc->bottom[b]);
 
-	while(rbtree_key_exists(alloc->allocated_nums, (void *) retval))
+	alloc->bottom[b] |= INDEX_BIT(index % WORD_BITS);
+	if(alloc->bottom[b] == 0xffffffff)
 	{
-		retval = ++alloc->next_num;
-		if(retval == 0)
-			retval = ++alloc->next_num;
-		else if(retval < 0)
-			retval = (alloc->next_num = 1);
-
-		// Check if all possibilities have been tried:
-		if(first_attempt == retval)
-			return 0;
+		alloc->middle[m] |= INDEX_BIT(b % WORD_BITS);
+		if(alloc->middle[m] == 0xffffffff)
+			alloc->top |= INDEX_BIT(m);
 	}
 
-	rbtree_insert(alloc->allocated_nums, (void *) retval, (void *) 1);
-	return retval;
+	return index + 1;
 }
 
 void number_allocator_free_num(struct number_allocator * alloc, int num)
 {
-	rbtree_delete(alloc->allocated_nums, (void *) num);
+	if(num <= 0 || num > NUMBER_ALLOCATOR_MAX_NUMBERS)
+		return;
+
+	unsigned int index = num - 1;
+	unsigned int b = index / WORD_BITS;
+	unsigned int m = b / WORD_BITS;
+
+	alloc->bottom[b] &= ~INDEX_BIT(index % WORD_BITS);
+	alloc->middle[m] &= ~INDEX_BIT(b % WORD_BITS);
+	alloc->top &= ~INDEX_BIT(m);
 }
 
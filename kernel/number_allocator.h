@@ -7,9 +7,17 @@
 
 /**
  * @defgroup numalloc Number Allocator
+ * The number allocator uses a three-level bitmap, where a bit in an upper
+ * level is set when the corresponding word in the level below is full. Free
+ * numbers are found by searching for the first zero bit of one word in each
+ * level, and freeing a number only clears bits, so neither operation
+ * allocates memory.
  * @{
  */
 
+/** Maximum number of numbers that can be allocated from an allocator. */
+#define NUMBER_ALLOCATOR_MAX_NUMBERS	(32 * 32 * 32)
+
 struct number_allocator;
 
 /**
@@ -24,9 +32,10 @@ struct number_allocator * number_allocator_new(void);
 void number_allocator_free(struct number_allocator * alloc);
 
 /**
- * Allocates a number from an allocator.
+ * Allocates a number from an allocator. The lowest free number is returned.
  * @param alloc the number allocator to allocate from.
- * @return the next possible number or 0 if a number could not be allocated.
+ * @return the allocated number, between 1 and `NUMBER_ALLOCATOR_MAX_NUMBERS`,
+ *         or 0 if a number could not be allocated.
  */
 int number_allocator_allocate_num(struct number_allocator * alloc);
 
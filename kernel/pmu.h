@@ -0,0 +1,71 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_PMU_H
+#define MORDAX_PMU_H
+
+#include "api/types.h"
+
+/**
+ * @defgroup pmu_driver Performance Monitors
+ * Low-level access to the event counters of the current processor. The
+ * performance monitors are enabled by `cycles_initialize`.
+ * @{
+ */
+
+/**
+ * Gets the number of event counters implemented by the processor.
+ * @return the number of event counters.
+ */
+unsigned int pmu_get_num_counters(void);
+
+/**
+ * Resets and starts the first event counters.
+ * @param events array with the event number to count with each counter.
+ * @param count the number of counters to start.
+ */
+void pmu_start(const uint32_t * events, unsigned int count);
+
+/**
+ * Stops the first event counters.
+ * @param count the number of counters to stop.
+ */
+void pmu_stop(unsigned int count);
+
+/**
+ * Reads the first event counters.
+ * @param values array to store the counter values in.
+ * @param count the number of counters to read.
+ */
+void pmu_read(uint32_t * values, unsigned int count);
+
+/**
+ * Starts an event counter which raises the overflow interrupt every time the
+ * specified number of events has occured.
+ * @param counter index of the counter to use.
+ * @param event the event number to count.
+ * @param period number of events between each interrupt.
+ */
+void pmu_overflow_start(unsigned int counter, uint32_t event, uint32_t period);
+
+/**
+ * Acknowledges the overflow interrupt of a counter started with
+ * `pmu_overflow_start` and restarts the period.
+ * @param counter index of the counter.
+ * @param period number of events until the next interrupt.
+ * @return `true` if the counter had overflowed.
+ */
+bool pmu_overflow_restart(unsigned int counter, uint32_t period);
+
+/**
+ * Stops a counter started with `pmu_overflow_start` and disables its
+ * overflow interrupt.
+ * @param counter index of the counter.
+ */
+void pmu_overflow_stop(unsigned int counter);
+
+/** @} */
+
+#endif
+
@@ -8,24 +8,17 @@
 #include "lock.h"
 #include "mm.h"
 #include "process.h"
-#include "rbtree.h"
 #include "scheduler.h"
 #include "service.h"
 #include "utils.h"
-
-struct process_resource
-{
-	enum process_resource_type type;
-	int identifier;
-	void * resource_ptr;
-};
+#include "waitset.h"
 
 // Allocates a thread ID for a thread added to the process.
 static tid_t allocate_tid(struct process * p, struct thread * t);
 // Frees a thread ID for a thread.
 static void free_tid(struct process * p, tid_t tid);
 // Frees a resource:
-static void free_resource(void * data);
+static void free_resource(void * resource_ptr, unsigned int type);
 
 struct process * process_create(struct mordax_process_info * procinfo)
 {
@@ -34,11 +27,10 @@ struct process * process_create(struct mordax_process_info * procinfo)
 	retval->threads = queue_new();
 	retval->pid = scheduler_allocate_pid();
 
-	retval->next_tid = 0;
-	retval->allocated_tids = rbtree_new(0, 0, 0, 0);
-
-	retval->resource_table = rbtree_new(0, 0, 0, free_resource);
-	retval->resnum_allocator = number_allocator_new();
+	retval->thread_table = handle_table_new();
+	retval->resource_table = handle_table_new();
+	retval->syscall_statistics = 0;
+	retval->info_page = 0;
 
 	retval->owner_group = procinfo->gid;
 	retval->owner_user = procinfo->uid;
@@ -49,6 +41,12 @@ struct process * process_create(struct mordax_process_info * procinfo)
 		retval->permissions = procinfo->permissions;
 	retval->translation_table = mmu_create_translation_table(retval->pid);
 
+	// Set the length of the time slices given to threads in the process:
+	if(procinfo->quantum == 0)
+		retval->quantum = SCHEDULER_DEFAULT_QUANTUM;
+	else
+		retval->quantum = max(SCHEDULER_MIN_QUANTUM, min(SCHEDULER_MAX_QUANTUM, procinfo->quantum));
+
 	// Create the initial stack:
 	if(procinfo->stack_length == MORDAX_PROCESS_INHERIT_STACK_SIZE)
 		retval->stack_size = active_thread->parent->stack_size;
@@ -62,23 +60,43 @@ struct process * process_create(struct mordax_process_info * procinfo)
 		struct mm_physical_memory mem;
 		if(!mm_allocate_physical(CONFIG_PAGE_SIZE, &mem))
 		{
-			debug_printf("Error: cannot allocate physical memory for stack!\n");
+			log_error("Error: cannot allocate physical memory for stack!\n");
 			goto _error_return;
 		}
 
-		debug_printf("\tMapping %x to %x for stack\n", mem.base,
+		log_debug("\tMapping %x to %x for stack\n", mem.base,
 			PROCESS_DEFAULT_STACK_TOP - ((i + 1) * CONFIG_PAGE_SIZE));
 		mmu_map(retval->translation_table, mem.base,
 			(void *) (PROCESS_DEFAULT_STACK_TOP - ((i + 1) * CONFIG_PAGE_SIZE)),
 			mem.size, MORDAX_TYPE_STACK, MORDAX_PERM_RW_RW);
 	}
 
+	// Create the information page. It is owned by the kernel, which updates
+	// it through its own mapping, so the page stays valid even if the
+	// process manages to unmap its copy:
+	retval->info_page = mm_allocate(CONFIG_PAGE_SIZE, CONFIG_PAGE_SIZE, MM_MEM_NORMAL);
+	if(retval->info_page == 0)
+	{
+		log_error("Error: cannot allocate memory for information page!\n");
+		goto _error_return;
+	}
+
+	mmu_map_shared(retval->translation_table, retval->info_page, PROCESS_INFO_PAGE_ADDRESS(retval),
+		CONFIG_PAGE_SIZE, MORDAX_TYPE_RODATA, MORDAX_PERM_RW_RO);
+
+	memclr(retval->info_page, CONFIG_PAGE_SIZE);
+	retval->info_page->version = MORDAX_INFO_PAGE_VERSION;
+	retval->info_page->pid = retval->pid;
+	retval->info_page->uid = retval->owner_user;
+	retval->info_page->gid = retval->owner_group;
+	retval->info_page->kernel_split = (void *) CONFIG_KERNEL_SPLIT;
+
 	if(procinfo->stack_source != 0)
 	{
 		if(active_thread != 0 && !mmu_access_permitted(active_thread->parent->translation_table,
 			procinfo->stack_source, procinfo->stack_source_length, MMU_ACCESS_READ|MMU_ACCESS_USER))
 		{
-			debug_printf("Error: cannot copy initial stack contents, access to memory is forbidden!\n");
+			log_error("Error: cannot copy initial stack contents, access to memory is forbidden!\n");
 			goto _error_return;
 		} else
 			memcpy_p((void *) (PROCESS_DEFAULT_STACK_TOP - procinfo->stack_source_length), retval,
@@ -99,7 +117,7 @@ struct process * process_create(struct mordax_process_info * procinfo)
 		struct mm_physical_memory mem;
 		if(!mm_allocate_physical(CONFIG_PAGE_SIZE, &mem))
 		{
-			debug_printf("Error: cannot allocate physical memory for process image!\n");
+			log_error("Error: cannot allocate physical memory for process image!\n");
 			goto _error_return;
 		}
 
@@ -110,20 +128,20 @@ struct process * process_create(struct mordax_process_info * procinfo)
 		{
 			type = MORDAX_TYPE_DATA;
 			permissions = MORDAX_PERM_RW_RW;
-			debug_printf("Mapping data memory: ");
+			log_debug("Mapping data memory: ");
 		} else if(i + 1 >= rodata_boundary)
 		{
 			type = MORDAX_TYPE_RODATA;
 			permissions = MORDAX_PERM_RW_RO;
-			debug_printf("Mapping rodata memory: ");
+			log_debug("Mapping rodata memory: ");
 		} else {
 			type = MORDAX_TYPE_CODE;
 	//		permissions = MORDAX_PERM_RW_RO;
 			permissions = MORDAX_PERM_RW_RW;
-			debug_printf("Mapping code memory: ");
+			log_debug("Mapping code memory: ");
 		}
 
-		debug_printf("%x to %x\n", mem.base, (i + 1) * CONFIG_PAGE_SIZE);
+		log_debug("%x to %x\n", mem.base, (i + 1) * CONFIG_PAGE_SIZE);
 		mmu_map(retval->translation_table, mem.base, (void *) ((i + 1) * CONFIG_PAGE_SIZE),
 			mem.size, type, permissions);
 	}
@@ -132,7 +150,7 @@ struct process * process_create(struct mordax_process_info * procinfo)
 	if(active_thread != 0 && procinfo->text_source != 0 && !mmu_access_permitted(active_thread->parent->translation_table,
 		procinfo->text_source, procinfo->text_source_length, MMU_ACCESS_READ|MMU_ACCESS_USER))
 	{
-		debug_printf("Error: cannot copy .text data, access to source memory is forbidden!\n");
+		log_error("Error: cannot copy .text data, access to source memory is forbidden!\n");
 		goto _error_return;
 	} else if(procinfo->text_source != 0)
 		memcpy_p((void *) 0x1000, retval, procinfo->text_source, active_thread == 0 ? 0 : active_thread->parent,
@@ -142,7 +160,7 @@ struct process * process_create(struct mordax_process_info * procinfo)
 	if(active_thread != 0 && procinfo->rodata_source != 0 && !mmu_access_permitted(active_thread->parent->translation_table,
 		procinfo->rodata_source, procinfo->rodata_source_length, MMU_ACCESS_READ|MMU_ACCESS_USER))
 	{
-		debug_printf("Error: cannot copy .data data, access to source memory is forbidden!\n");
+		log_error("Error: cannot copy .data data, access to source memory is forbidden!\n");
 		goto _error_return;
 	} else if(procinfo->rodata_source != 0)
 		memcpy_p((void *) ((1 + text_pages) * CONFIG_PAGE_SIZE), retval,
@@ -152,7 +170,7 @@ struct process * process_create(struct mordax_process_info * procinfo)
 	if(active_thread != 0 && procinfo->data_source != 0 && !mmu_access_permitted(active_thread->parent->translation_table,
 		procinfo->data_source, procinfo->data_source_length, MMU_ACCESS_READ|MMU_ACCESS_USER))
 	{
-		debug_printf("Error: cannot copy .data data, access to source memory is forbidden!\n");
+		log_error("Error: cannot copy .data data, access to source memory is forbidden!\n");
 		goto _error_return;
 	} else if(procinfo->data_source != 0)
 		memcpy_p((void *) ((1 + text_pages + rodata_pages) * CONFIG_PAGE_SIZE), retval, procinfo->data_source,
@@ -161,10 +179,12 @@ struct process * process_create(struct mordax_process_info * procinfo)
 	return retval;
 
 _error_return:
-	rbtree_free(retval->allocated_tids);
+	handle_table_free(retval->thread_table, 0);
+	handle_table_free(retval->resource_table, 0);
 	scheduler_free_pid(retval->pid);
 	queue_free(retval->threads, 0);
 	mmu_free_translation_table(retval->translation_table);
+	mm_free(retval->info_page);
 
 	mm_free(retval);
 	return 0;
@@ -172,44 +192,42 @@ _error_return:
 
 void process_free(struct process * p)
 {
-	rbtree_free(p->resource_table); // also frees the resources in the table
+	handle_table_free(p->resource_table, free_resource);
 	queue_free(p->threads, (queue_data_free_func) thread_free);
-	number_allocator_free(p->resnum_allocator);
 	scheduler_free_pid(p->pid);
-	rbtree_free(p->allocated_tids);
+	handle_table_free(p->thread_table, 0);
 	mmu_free_translation_table(p->translation_table);
+	mm_free(p->info_page);
+	mm_free(p->syscall_statistics);
 	mm_free(p);
 }
 
-static void free_resource(void * data)
+static void free_resource(void * resource_ptr, unsigned int type)
 {
-	struct process_resource * res = data;
-	if(res == 0)
-		return;
-
-	switch(res->type)
+	switch(type)
 	{
 		case PROCESS_RESOURCE_SOCKET:
-			socket_destroy(res->resource_ptr);
+			socket_destroy(resource_ptr);
 			break;
 		case PROCESS_RESOURCE_SERVICE:
-			service_destroy(res->resource_ptr);
+			service_destroy(resource_ptr);
 			break;
 		case PROCESS_RESOURCE_LOCK:
-			lock_destroy(res->resource_ptr);
+			lock_destroy(resource_ptr);
 			break;
 		case PROCESS_RESOURCE_DT_NODE:
 			// DT nodes are a direct part of the kernel DT and
 			// cannot be freed.
 			break;
 		case PROCESS_RESOURCE_IRQ:
-			irq_object_destroy(res->resource_ptr);
+			irq_object_destroy(resource_ptr);
+			break;
+		case PROCESS_RESOURCE_WAITSET:
+			waitset_destroy(resource_ptr);
 			break;
 		default:
 			break;
 	}
-
-	mm_free(res);
 }
 
 void process_add_thread(struct process * p, struct thread * t)
@@ -217,7 +235,7 @@ void process_add_thread(struct process * p, struct thread * t)
 	queue_add_front(p->threads, t);
 	++p->num_threads;
 	t->tid = allocate_tid(p, t);
-	debug_printf("Added thread with TID %d to process %d, number of threads in process is now %d\n",
+	log_debug("Added thread with TID %d to process %d, number of threads in process is now %d\n",
 		t->tid, p->pid, p->num_threads);
 }
 
@@ -243,14 +261,14 @@ struct thread * process_remove_thread(struct process * p, struct thread * t)
 
 	if(current != 0)
 	{
-		debug_printf("Thread %d removed from process %d\n", t->tid, p->pid);
+		log_debug("Thread %d removed from process %d\n", t->tid, p->pid);
 		queue_remove_node(p->threads, current);
 		--p->num_threads;
 	}
 
 	if(p->num_threads == 0)
 	{
-		debug_printf("Last thread removed from process, freeing process %d\n", p->pid);
+		log_debug("Last thread removed from process, freeing process %d\n", p->pid);
 		process_free(p);
 		t->parent = 0;
 	}
@@ -261,79 +279,47 @@ struct thread * process_remove_thread(struct process * p, struct thread * t)
 unsigned int process_add_resource(struct process * p, enum process_resource_type type,
 	void * resource_ptr)
 {
-	unsigned int identifier = number_allocator_allocate_num(p->resnum_allocator);
-	if(identifier == 0)
-		return 0;
-
-	struct process_resource * res = mm_allocate(sizeof(struct process_resource),
-		MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
-
-	res->type = type;
-	res->identifier = identifier;
-	res->resource_ptr = resource_ptr;
-
-	rbtree_insert(p->resource_table, (void *) identifier, (void *) res);
-	return identifier;
+	int identifier = handle_table_insert(p->resource_table, resource_ptr, type);
+	return identifier < 0 ? 0 : identifier;
 }
 
 void * process_get_resource(struct process * p, unsigned int identifier,
 	enum process_resource_type * type)
 {
-	struct process_resource * res = rbtree_get_value(p->resource_table, (void *) identifier);
-	if(res == 0)
-		return 0;
-
-	*type = res->type;
-	return res->resource_ptr;
+	unsigned int tag;
+	void * retval = handle_table_get(p->resource_table, identifier, &tag);
+	if(retval != 0)
+		*type = tag;
+	return retval;
 }
 
 void * process_remove_resource(struct process * p, unsigned int identifier,
 	enum process_resource_type * type)
 {
-	struct process_resource * resource = rbtree_delete(p->resource_table, (void *) identifier);
-	void * retval = 0;
-
-	if(resource != 0)
-	{
-		number_allocator_free_num(p->resnum_allocator, resource->identifier);
-		*type = resource->type;
-		retval = resource->resource_ptr;
-		mm_free(resource);
-	}
-
+	unsigned int tag;
+	void * retval = handle_table_remove(p->resource_table, identifier, &tag);
+	if(retval != 0)
+		*type = tag;
 	return retval;
 }
 
 struct thread * process_get_thread_by_tid(struct process * p, tid_t tid)
 {
-	if(!rbtree_key_exists(p->allocated_tids, (void *) tid))
-		return 0;
-	else
-		return rbtree_get_value(p->allocated_tids, (void *) tid);
+	return handle_table_get(p->thread_table, tid, 0);
 }
 
 static tid_t allocate_tid(struct process * p, struct thread * t)
 {
-	tid_t retval = p->next_tid++;
-	tid_t first_attempt = retval;
-
-	while(rbtree_key_exists(p->allocated_tids, (void *) retval))
-	{
-		retval = p->next_tid++;
+	tid_t retval = handle_table_insert(p->thread_table, t, 0);
+	if(retval < 0)
+		return -1;
 
-		// Check if all possibilities have been tried:
-		if(first_attempt == retval)
-			return -1;
-	}
-
-	rbtree_insert(p->allocated_tids, (void *) retval, t);
-	debug_printf("Process %d allocated TID %d\n", p->pid, retval);
+	log_debug("Process %d allocated TID %d\n", p->pid, retval);
 	return retval;
 }
 
 static void free_tid(struct process * p, tid_t tid)
 {
-	debug_printf("Process %d freed TID %d\n", p->pid, tid);
-	rbtree_delete(p->allocated_tids, (void *) tid);
+	log_debug("Process %d freed TID %d\n", p->pid, tid);
+	handle_table_remove(p->thread_table, tid, 0);
 }
-
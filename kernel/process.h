@@ -5,15 +5,16 @@
 #ifndef MORDAX_PROCESS_H
 #define MORDAX_PROCESS_H
 
+#include "handle_table.h"
 #include "mmu.h"
-#include "number_allocator.h"
 #include "queue.h"
-#include "rbtree.h"
 #include "service.h"
 #include "socket.h"
 
+#include "api/info.h"
 #include "api/memory.h"
 #include "api/process.h"
+#include "api/syscall_statistics.h"
 #include "api/types.h"
 
 #ifndef CONFIG_DEFAULT_STACK_SIZE
@@ -42,6 +43,14 @@
  */
 #define PROCESS_START_ADDRESS	(void *) CONFIG_PAGE_SIZE
 
+/**
+ * Address of the information page of a process. The information page is
+ * mapped read-only directly below the initial stack, so that the initial
+ * thread faults if it overflows its stack.
+ */
+#define PROCESS_INFO_PAGE_ADDRESS(p) \
+	((struct mordax_info_page *) (PROCESS_DEFAULT_STACK_TOP - (p)->stack_size - CONFIG_PAGE_SIZE))
+
 struct thread;
 
 struct process
@@ -51,17 +60,22 @@ struct process
 	unsigned int num_threads;
 	pid_t pid;
 
-	struct rbtree * allocated_tids;
-	tid_t next_tid;
-
-	struct rbtree * resource_table;
-	struct number_allocator * resnum_allocator;
+	struct handle_table * thread_table;
+	struct handle_table * resource_table;
 
 	uint32_t permissions;
+	uint32_t quantum;
 	gid_t owner_group;
 	uid_t owner_user;
 
 	size_t stack_size;
+	// Kernel address of the information page, which is mapped into the
+	// process at PROCESS_INFO_PAGE_ADDRESS:
+	struct mordax_info_page * info_page;
+
+	// System call statistics, indexed by system call number. Allocated on
+	// the first system call of the process:
+	struct mordax_syscall_statistics * syscall_statistics;
 };
 
 enum process_resource_type
@@ -71,6 +85,7 @@ enum process_resource_type
 	PROCESS_RESOURCE_LOCK,
 	PROCESS_RESOURCE_DT_NODE,
 	PROCESS_RESOURCE_IRQ,
+	PROCESS_RESOURCE_WAITSET,
 };
 
 /**
@@ -0,0 +1,154 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#include "context.h"
+#include "debug.h"
+#include "irq.h"
+#include "mm.h"
+#include "mmu.h"
+#include "pmu.h"
+#include "process.h"
+#include "profile.h"
+#include "scheduler.h"
+#include "smp.h"
+#include "thread.h"
+#include "utils.h"
+
+#include "api/errno.h"
+
+#ifdef CONFIG_PROFILE_SAMPLES
+
+// Sample buffer. Samples are only added and removed while holding the kernel
+// lock. The positions only increase and are reduced modulo the buffer size
+// to get the index in the buffer:
+static struct mordax_profile_sample * samples = 0;
+static unsigned int samples_head = 0, samples_tail = 0;
+static uint32_t samples_dropped = 0;
+
+// Index of the event counter used for sampling:
+static unsigned int sample_counter;
+
+// Sampling settings. The generation is increased every time the settings
+// change, so that each processor can tell if it has applied them:
+static uint32_t sample_event, sample_period = 0;
+static unsigned int generation = 0;
+static unsigned int cpu_generation[CONFIG_MAX_CPUS];
+
+// Overflow interrupt handler, records a sample of the interrupted thread:
+static void profile_irq_handler(struct thread_context * context, unsigned irq, void * data_ptr);
+
+void profile_initialize(struct dt_node * pmu_node)
+{
+	uint32_t irq_number;
+	if(!dt_get_array32_property(pmu_node, "interrupts", &irq_number, 1))
+	{
+		log_error("Error: performance monitor node \"%s\" has no \"interrupts\" property\n",
+			pmu_node->name);
+		return;
+	}
+
+	unsigned int num_counters = pmu_get_num_counters();
+	if(num_counters == 0)
+	{
+		log_warning("Performance monitors have no event counters, sampling profiler disabled\n");
+		return;
+	}
+	sample_counter = num_counters - 1;
+
+	samples = mm_allocate(CONFIG_PROFILE_SAMPLES * sizeof(struct mordax_profile_sample),
+		MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
+
+	irq_register(irq_number, profile_irq_handler, 0);
+	irq_enable(irq_number);
+
+	log_info("Sampling profiler using event counter %d, IRQ %d\n", sample_counter, irq_number);
+}
+
+int profile_start(uint32_t event, uint32_t period)
+{
+	if(samples == 0)
+		return -ENOSYS;
+	if(event > MORDAX_PMU_MAX_EVENT || (period != 0 && period < MORDAX_PROFILE_MIN_PERIOD))
+		return -EINVAL;
+
+	sample_event = event;
+	sample_period = period;
+	++generation;
+
+	profile_update();
+	return 0;
+}
+
+void profile_update(void)
+{
+	unsigned int cpu = cpu_get_id();
+	if(cpu_generation[cpu] == generation)
+		return;
+	cpu_generation[cpu] = generation;
+
+	if(sample_period != 0)
+		pmu_overflow_start(sample_counter, sample_event, sample_period);
+	else
+		pmu_overflow_stop(sample_counter);
+}
+
+size_t profile_read(struct mordax_profile_sample * buffer, size_t length, uint32_t * dropped)
+{
+	size_t retval = 0;
+	for(; retval < length && samples_tail != samples_head; ++retval, ++samples_tail)
+		memcpy(&buffer[retval], &samples[samples_tail % CONFIG_PROFILE_SAMPLES],
+			sizeof(struct mordax_profile_sample));
+
+	*dropped = samples_dropped;
+	samples_dropped = 0;
+	return retval;
+}
+
+static void profile_irq_handler(struct thread_context * context, unsigned irq, void * data_ptr)
+{
+	if(!pmu_overflow_restart(sample_counter, sample_period))
+		return;
+
+	// Sampling may have been stopped by another processor:
+	if(sample_period == 0)
+	{
+		profile_update();
+		return;
+	}
+
+	if(samples_head - samples_tail == CONFIG_PROFILE_SAMPLES)
+	{
+		++samples_dropped;
+		return;
+	}
+
+	struct mordax_profile_sample * sample = &samples[samples_head % CONFIG_PROFILE_SAMPLES];
+	struct thread * t = active_thread;
+
+	sample->pc = (uint32_t) context_get_pc(context);
+	sample->lr = (uint32_t) context_get_lr(context);
+	sample->sp = (uint32_t) context_get_sp(context);
+	sample->pid = t != 0 ? t->parent->pid : 0;
+	sample->tid = t != 0 ? t->tid : 0;
+	sample->cpu = cpu_get_id();
+	sample->flags = 0;
+	sample->stack_words = 0;
+
+	if(context_get_mode(context) != CONTEXT_USERMODE)
+		sample->flags |= MORDAX_PROFILE_SAMPLE_KERNEL;
+	else if((sample->sp & 3) == 0 && mmu_user_readable((void *) sample->sp))
+	{
+		// Only the page the stack pointer points into is copied from, so
+		// that checking one page is enough to avoid faulting. Unwinding is
+		// left to the tools, as threads are not built with frame pointers:
+		unsigned int words = (CONFIG_PAGE_SIZE - (sample->sp & (CONFIG_PAGE_SIZE - 1))) / sizeof(uint32_t);
+		sample->stack_words = min(words, MORDAX_PROFILE_STACK_WORDS);
+		memcpy(sample->stack, (void *) sample->sp, sample->stack_words * sizeof(uint32_t));
+	}
+
+	++samples_head;
+}
+
+#endif
+
@@ -0,0 +1,65 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_PROFILE_H
+#define MORDAX_PROFILE_H
+
+#include "dt.h"
+
+#include "api/profile.h"
+#include "api/types.h"
+
+/**
+ * @ingroup profile
+ * The profiler is enabled by setting `CONFIG_PROFILE_SAMPLES` to the number of
+ * samples in the sample buffer. It uses the last event counter of each
+ * processor, which is then not available to threads, and needs the overflow
+ * interrupt of the performance monitors, which is found in the device tree.
+ * @{
+ */
+
+#ifdef CONFIG_PROFILE_SAMPLES
+
+/**
+ * Sets up the sampling profiler.
+ * @param pmu_node device tree node for the performance monitors.
+ */
+void profile_initialize(struct dt_node * pmu_node);
+
+/**
+ * Starts or stops sampling. Each processor changes to the new settings the
+ * next time it reschedules; the calling processor changes immediately.
+ * @param event the event number to count.
+ * @param period number of events between each sample, at least
+ *               `MORDAX_PROFILE_MIN_PERIOD`, or 0 to stop sampling.
+ * @return 0 on success or a negative error code on failure.
+ */
+int profile_start(uint32_t event, uint32_t period);
+
+/**
+ * Applies changes to the sampling settings to the current processor.
+ */
+void profile_update(void);
+
+/**
+ * Removes the oldest samples from the sample buffer.
+ * @param buffer array to copy the samples to.
+ * @param length number of entries in the array.
+ * @param dropped pointer to where the number of samples dropped because the
+ *                sample buffer was full since the last call is stored.
+ * @return the number of samples copied.
+ */
+size_t profile_read(struct mordax_profile_sample * buffer, size_t length, uint32_t * dropped);
+
+#else
+
+#define profile_initialize(pmu_node)	((void) 0)
+#define profile_update()		((void) 0)
+
+#endif
+
+/** @} */
+
+#endif
+
@@ -2,58 +2,109 @@
 // (c) Kristian Klomsten Skordal 2013 <kristian.skordal@gmail.com>
 // Report bugs and issues on <http://github.com/skordal/mordax/issues>
 
+#include "api/errno.h"
 #include "api/memory.h"
 #include "api/process.h"
 
 #include "context.h"
+#include "cycles.h"
 #include "debug.h"
 #include "kernel.h"
+#include "mm.h"
 #include "number_allocator.h"
 #include "process.h"
+#include "profile.h"
 #include "queue.h"
 #include "rbtree.h"
 #include "scheduler.h"
 #include "stack.h"
+#include "trace.h"
 #include "utils.h"
 
+// Shortest interval the scheduler timer is programmed with, in microseconds:
+#define SCHEDULER_MIN_INTERVAL	50
+
 static struct timer_driver * scheduler_timer;
 
-// Thread queues:
-static struct queue * running_queue;
+// Monotonic clock, in microseconds since the scheduler was started, at the
+// start of the current timer interval, and the length of the interval:
+static uint64_t interval_start = 0;
+static unsigned int current_interval = SCHEDULER_DEFAULT_QUANTUM;
+
+// Queue of blocked threads, shared by all processors:
 static struct queue * blocking_queue;
+// Queue of sleeping threads, sorted by wakeup time, shared by all processors:
+static struct queue * sleeping_queue;
 
 // PID allocator object:
 static struct number_allocator * pid_allocator;
 
-// Currently running thread:
-struct thread * active_thread = 0;
-
-// Idle thread:
-static struct thread * idle_thread;
+// Scheduler state for each processor:
+struct scheduler_cpu scheduler_cpus[CONFIG_MAX_CPUS];
 
 // Idle thread loop:
 extern void idle_thread_loop(void);
 
+// Timer callback, advances the clock and reschedules:
+static void scheduler_timer_tick(void);
+// Does a scheduling pass, the involuntary argument is set if the running
+// thread is being preempted:
+static void reschedule(bool involuntary);
+// Gets the current time, in microseconds since the scheduler was started:
+static uint64_t scheduler_time(void);
+// Restarts the scheduler timer with a new interval:
+static void program_timer(uint64_t now, unsigned int interval);
+// Charges the running thread for the processor time it has used since it was last charged:
+static void charge_thread(struct scheduler_cpu * cpu, struct thread * t, uint64_t now);
+// Gives throttled real-time threads that have reached their deadline a new budget:
+static void release_throttled(struct scheduler_cpu * cpu, uint64_t now);
+// Wakes up the sleeping threads that have reached their wakeup time:
+static void release_sleeping(uint64_t now);
+// Inserts a real-time thread into a queue sorted by deadline:
+static void insert_by_deadline(struct queue * queue, struct thread * t);
+// Calculates the bandwidth used by a real-time thread, in parts per million:
+static uint32_t utilization(uint32_t budget, uint32_t period);
+// Gets the cycle count of a processor:
+static uint64_t cpu_cycles(unsigned int cpu);
+// Charges a thread for the time it has been running:
+static void stop_running(struct thread * t, bool voluntary);
+// Stores the statistics for a thread in a statistics buffer entry:
+static void get_statistics(struct mordax_thread_statistics * entry, struct thread * t, uint32_t state);
+// Stores the statistics for the threads in a queue belonging to a process, or
+// all threads if the process is 0, returns the new number of threads:
+static unsigned int get_queue_statistics(struct queue * queue, struct mordax_thread_statistics * buffer,
+	unsigned int length, unsigned int count, uint32_t state, struct process * process);
+// Finds the process with the specified PID among the threads in a queue:
+static struct process * find_process(struct queue * queue, pid_t pid);
+// Selects the processor to run a thread that becomes ready on:
+static unsigned int select_cpu(struct thread * t);
+// Adds a thread to the running queue of a processor and notifies the processor:
+static void add_to_cpu(struct thread * t, unsigned int cpu);
+// Removes a thread from a queue, returns true if the thread was in the queue:
+static bool remove_from_queue(struct queue * queue, struct thread * t);
+// Removes a thread from the queues of a processor, returns true if the thread was found:
+static bool remove_from_cpu(struct scheduler_cpu * cpu, struct thread * t);
+
 bool scheduler_initialize(struct timer_driver * timer, physical_ptr initproc_start,
 	size_t initproc_size)
 {
 	scheduler_timer = timer;
 	if(timer == 0)
 	{
-		debug_printf("Error: no scheduler timer available!\n");
+		log_error("Error: no scheduler timer available!\n");
 		return false;
 	}
 
 	// Set up the timer:
-	scheduler_timer->set_interval(100000);
-	scheduler_timer->set_callback(scheduler_reschedule);
+	scheduler_timer->set_interval(SCHEDULER_DEFAULT_QUANTUM);
+	scheduler_timer->set_callback(scheduler_timer_tick);
 
-	running_queue = queue_new();
 	blocking_queue = queue_new();
+	sleeping_queue = queue_new();
 	pid_allocator = number_allocator_new();
 
-	// Create the idle process + thread:
-	debug_printf("Creating idle process...\n");
+	// Create the idle process, with one idle thread for each processor:
+	log_info("Creating idle process...\n");
 	struct mordax_process_info idle_process_info = {
 		.entry_point = (void *) idle_thread_loop,
 		.permissions = MORDAX_PROCESS_NO_PERMISSIONS
@@ -61,13 +112,38 @@ bool scheduler_initialize(struct timer_driver * timer, physical_ptr initproc_sta
 	struct process * idle_process = process_create(&idle_process_info);
 	if(idle_process == 0)
 		kernel_panic("could not create idle process");
-	idle_thread = process_add_new_thread(idle_process, (void *) idle_thread_loop, 0);
-	if(idle_thread == 0)
-		kernel_panic("could not create idle thread");
-	context_set_mode(idle_thread->context, CONTEXT_KERNELMODE);
+	for(unsigned int cpu = 0; cpu < CONFIG_MAX_CPUS; ++cpu)
+	{
+		// The idle threads need a stack for draining the kernel log:
+		uint8_t * idle_stack = mm_allocate(SCHEDULER_IDLE_STACK_SIZE, MM_DEFAULT_ALIGNMENT,
+			MM_MEM_NORMAL);
+		struct thread * idle_thread = process_add_new_thread(idle_process, (void *) idle_thread_loop,
+			idle_stack + SCHEDULER_IDLE_STACK_SIZE);
+		if(idle_thread == 0)
+			kernel_panic("could not create idle thread");
+		context_set_mode(idle_thread->context, CONTEXT_KERNELMODE);
+		idle_thread->cpu = cpu;
+
+		scheduler_cpus[cpu].realtime_queue = queue_new();
+		scheduler_cpus[cpu].throttled_queue = queue_new();
+		scheduler_cpus[cpu].realtime_utilization = 0;
+		scheduler_cpus[cpu].running_queue = queue_new();
+		scheduler_cpus[cpu].current_thread = 0;
+		scheduler_cpus[cpu].idle_thread = idle_thread;
+		scheduler_cpus[cpu].online = false;
+		scheduler_cpus[cpu].preempt = false;
+		scheduler_cpus[cpu].cycles = 0;
+		scheduler_cpus[cpu].cycles_last = 0;
+		scheduler_cpus[cpu].slice_start = 0;
+	}
+
+	// Only the boot processor is started by the kernel for now:
+	scheduler_cpus[cpu_get_id()].online = true;
+	cycles_initialize();
+	trace_initialize();
 
 	// Map the initial process:
-	debug_printf("Creating initial process...\n");
+	log_info("Creating initial process...\n");
 	uint8_t * initproc_image = mmu_map(0, initproc_start, initproc_start, initproc_size,
 		MORDAX_TYPE_DATA, MORDAX_PERM_RO_RO);
 
@@ -94,7 +170,8 @@ bool scheduler_initialize(struct timer_driver * timer, physical_ptr initproc_sta
 	// Add the new thread to the scheduler:
 	scheduler_add_thread(init_thread);
 
-	// Start the scheduler:
+	// Start the scheduler, from now on the kernel log is drained by the idle threads:
+	debug_start_deferred_output();
 	scheduler_timer->start();
 
 	while(1) asm volatile("wfi\n\t");
@@ -103,90 +180,327 @@ bool scheduler_initialize(struct timer_driver * timer, physical_ptr initproc_sta
 
 void scheduler_add_thread(struct thread * t)
 {
-	queue_add_front(running_queue, t);
+	add_to_cpu(t, select_cpu(t));
 }
 
 struct thread * scheduler_remove_thread(struct thread * t)
 {
-	if(t == active_thread)
-		active_thread = 0;
+	struct scheduler_cpu * cpu = &scheduler_cpus[t->cpu];
 
-	// Remove the thread from the running queue:
-	struct queue_node * current = running_queue->first;
-	while(current != 0)
-	{
-		struct thread * current_thread = current->data;
-		if(current_thread == t)
-		{
-			queue_remove_node(running_queue, current);
-			break;
-		}
+	if(t == cpu->current_thread)
+		cpu->current_thread = 0;
+	else
+		remove_from_cpu(cpu, t);
 
-		current = current->next;
-	}
+	// Release the bandwidth reserved by the thread:
+	if(t->period != 0)
+		cpu->realtime_utilization -= utilization(t->budget, t->period);
 
 	return t;
 }
 
 void scheduler_move_thread_to_blocking(struct thread * t)
 {
-	struct queue_node * current = running_queue->first;
+	struct scheduler_cpu * cpu = &scheduler_cpus[t->cpu];
 
-	if(t == active_thread)
+	if(t == cpu->current_thread)
 	{
-		context_copy(t->context, current_context);
+		charge_thread(cpu, t, scheduler_time());
+		stop_running(t, true);
 		queue_add_back(blocking_queue, t);
-		active_thread = 0;
-	} else while(current != 0)
-	{
-		struct thread * current_thread = current->data;
-		if(current_thread == t)
-		{
-			queue_remove_node(running_queue, current);
-			queue_add_back(blocking_queue, current_thread);
-			break;
-		}
-
-		current = current->next;
-	}
+		cpu->current_thread = 0;
+	} else if(remove_from_cpu(cpu, t))
+		queue_add_back(blocking_queue, t);
+}
 
+void scheduler_sleep_thread(struct thread * t, uint32_t microseconds)
+{
+	struct scheduler_cpu * cpu = &scheduler_cpus[t->cpu];
+	uint64_t now = scheduler_time();
+
+	charge_thread(cpu, t, now);
+	stop_running(t, true);
+	cpu->current_thread = 0;
+
+	t->wakeup_time = now + microseconds;
+	struct queue_node * node = sleeping_queue->first;
+	while(node != 0 && ((struct thread *) node->data)->wakeup_time <= t->wakeup_time)
+		node = node->next;
+	queue_insert_before(sleeping_queue, node, t);
 }
 
 void scheduler_move_thread_to_running(struct thread * t)
 {
-	struct queue_node * current = blocking_queue->first;
-	while(current != 0)
+	if(remove_from_queue(blocking_queue, t))
+		add_to_cpu(t, select_cpu(t));
+}
+
+void scheduler_wake_thread(struct thread * t, unsigned int boost)
+{
+	if(t->boost < boost)
+		t->boost = boost;
+	scheduler_move_thread_to_running(t);
+}
+
+int scheduler_set_realtime(struct thread * t, uint32_t budget, uint32_t period)
+{
+	struct scheduler_cpu * cpu = &scheduler_cpus[t->cpu];
+
+	if(budget != 0 && (period < SCHEDULER_REALTIME_MIN_PERIOD || budget > period))
+		return -EINVAL;
+
+	// Admission control, the total bandwidth of the real-time threads on a
+	// processor must leave some time for best-effort threads:
+	uint32_t old_utilization = t->period != 0 ? utilization(t->budget, t->period) : 0;
+	uint32_t new_utilization = budget != 0 ? utilization(budget, period) : 0;
+	if(cpu->realtime_utilization - old_utilization + new_utilization > SCHEDULER_REALTIME_MAX_UTILIZATION)
+		return -EBUSY;
+	cpu->realtime_utilization = cpu->realtime_utilization - old_utilization + new_utilization;
+
+	// Move a ready thread to the queue of its new scheduling class. The
+	// running thread is moved when it is next rescheduled:
+	bool ready = t != cpu->current_thread && remove_from_cpu(cpu, t);
+
+	uint64_t now = scheduler_time();
+	if(t == cpu->current_thread)
+		charge_thread(cpu, t, now);
+
+	t->budget = budget;
+	t->period = budget != 0 ? period : 0;
+	t->remaining_budget = budget;
+	t->deadline = now + period;
+
+	if(ready)
 	{
-		struct thread * current_thread = current->data;
-		if(current_thread == t)
-		{
-			queue_remove_node(blocking_queue, current);
-			queue_add_front(running_queue, current->data);
-			break;
-		}
+		if(t->period != 0)
+			insert_by_deadline(cpu->realtime_queue, t);
+		else
+			queue_add_back(cpu->running_queue, t);
 	}
+
+	// Let the scheduler select the thread with the earliest deadline:
+	if(t->cpu == cpu_get_id())
+		cpu->preempt = true;
+
+	return 0;
 }
 
 void scheduler_reschedule()
 {
+	reschedule(false);
+}
+
+static void reschedule(bool involuntary)
+{
+	struct scheduler_cpu * cpu = &scheduler_cpus[cpu_get_id()];
+	struct thread * previous_thread = cpu->current_thread;
 	struct thread * next_thread;
 
-	if(active_thread != 0 && active_thread != idle_thread)
-		queue_add_back(running_queue, active_thread);
+	bool preempted = cpu->preempt;
+	cpu->preempt = false;
+
+	// Reading the cycle count on every pass also keeps the 64-bit count
+	// correct when the cycle counter wraps around:
+	uint64_t now = cpu_cycles(cpu_get_id());
+	uint64_t time = scheduler_time();
+	trace_clock(now, time);
+
+	if(previous_thread != 0)
+		charge_thread(cpu, previous_thread, time);
+	cpu->slice_start = time;
+	release_throttled(cpu, time);
+
+	// Threads woken up on this processor are considered in this pass, so
+	// they do not have to cause another one:
+	release_sleeping(time);
+	cpu->preempt = false;
+
+	// A real-time thread is put back into the queue before the next thread
+	// is selected, so that it keeps running if it still has the earliest
+	// deadline. If it has used up its budget, it is throttled:
+	if(previous_thread != 0 && previous_thread->period != 0)
+	{
+		if(previous_thread->remaining_budget == 0)
+			insert_by_deadline(cpu->throttled_queue, previous_thread);
+		else
+			insert_by_deadline(cpu->realtime_queue, previous_thread);
+	}
+
+	// Best-effort threads only run when no real-time thread is ready:
+	if(!queue_remove_front(cpu->realtime_queue, (void **) &next_thread)
+		&& !queue_remove_front(cpu->running_queue, (void **) &next_thread))
+		next_thread = 0;
+
+	// A best-effort thread that has used up its time slice, or that yields,
+	// is moved to the back of the queue and gets a new time slice. Its
+	// wakeup boost decays with every time slice it uses up. A preempted
+	// thread keeps its place at the front of the queue and the rest of its
+	// time slice:
+	if(previous_thread != 0 && previous_thread != cpu->idle_thread && previous_thread->period == 0)
+	{
+		bool expired = previous_thread->remaining_quantum == 0;
+		if(expired && previous_thread->boost > 0)
+			--previous_thread->boost;
+
+		if(next_thread == 0)
+			next_thread = previous_thread;
+		else if(!expired && (preempted || involuntary))
+			queue_add_front(cpu->running_queue, previous_thread);
+		else {
+			previous_thread->remaining_quantum = previous_thread->parent->quantum;
+			queue_add_back(cpu->running_queue, previous_thread);
+		}
+
+		if(previous_thread->remaining_quantum == 0)
+			previous_thread->remaining_quantum = previous_thread->parent->quantum;
+	}
 
 	// If no thread can be run, schedule the idle thread:
-	if(!queue_remove_front(running_queue, (void **) &next_thread))
-		next_thread = idle_thread;
+	if(next_thread == 0)
+		next_thread = cpu->idle_thread;
 
-	if(active_thread != 0)
-		context_copy(active_thread->context, current_context);
-	context_copy(current_context, next_thread->context);
+	if(next_thread != previous_thread)
+	{
+		if(previous_thread != 0)
+			stop_running(previous_thread, !(involuntary || preempted));
 
-	if(next_thread == idle_thread)
-		mmu_set_translation_table(0);
+		// Idle threads are never in a running queue, so they never wait:
+		if(next_thread != cpu->idle_thread)
+			next_thread->wait_time += now - next_thread->timestamp;
+		next_thread->timestamp = now;
+
+		trace_event(MORDAX_TRACE_SWITCH, next_thread->parent->pid, next_thread->tid);
+	}
+
+	// Program the timer to interrupt when the time slice of the next thread
+	// or the budget of a real-time thread runs out, or when the first
+	// throttled or sleeping thread is to be released:
+	unsigned int interval;
+	if(next_thread == cpu->idle_thread)
+		interval = SCHEDULER_DEFAULT_QUANTUM;
+	else if(next_thread->period != 0)
+		interval = min(next_thread->remaining_budget, SCHEDULER_MAX_QUANTUM);
 	else
+		interval = next_thread->remaining_quantum;
+	if(cpu->throttled_queue->first != 0)
+	{
+		struct thread * first_throttled = cpu->throttled_queue->first->data;
+		if(first_throttled->deadline - time < interval)
+			interval = first_throttled->deadline - time;
+	}
+	if(sleeping_queue->first != 0)
+	{
+		struct thread * first_sleeping = sleeping_queue->first->data;
+		if(first_sleeping->wakeup_time - time < interval)
+			interval = first_sleeping->wakeup_time - time;
+	}
+	program_timer(time, max(interval, SCHEDULER_MIN_INTERVAL));
+
+	// The exception handlers store the context of the active thread directly
+	// into its context block, so switching threads only requires changing
+	// the current context used when returning from the exception:
+	context_set_current(next_thread->context);
+	context_fpu_switch(next_thread->context);
+	context_pmu_switch(next_thread->context);
+	profile_update();
+
+	if(next_thread == cpu->idle_thread)
+		mmu_set_translation_table(0);
+	else {
 		mmu_set_translation_table(next_thread->parent->translation_table);
-	active_thread = next_thread;
+
+		// The clock in the information page is only updated here, when a
+		// thread of the process is scheduled and on every scheduler timer
+		// interrupt while it runs. The page is written through its kernel
+		// mapping, which the process cannot unmap:
+		next_thread->parent->info_page->clock = time;
+		context_set_thread_id(next_thread->tid);
+	}
+	cpu->current_thread = next_thread;
+}
+
+bool scheduler_preemption_pending(void)
+{
+	return scheduler_cpus[cpu_get_id()].preempt;
+}
+
+static void scheduler_timer_tick(void)
+{
+	interval_start += current_interval;
+	reschedule(true);
+}
+
+uint64_t scheduler_get_time(void)
+{
+	if(scheduler_timer == 0)
+		return 0;
+	return scheduler_time();
+}
+
+uint64_t scheduler_get_cycles(void)
+{
+	return cpu_cycles(cpu_get_id());
+}
+
+unsigned int scheduler_get_statistics(struct mordax_thread_statistics * buffer, unsigned int length,
+	struct process * process)
+{
+	unsigned int retval = 0;
+
+	for(unsigned int cpu = 0; cpu < CONFIG_MAX_CPUS; ++cpu)
+	{
+		struct scheduler_cpu * state = &scheduler_cpus[cpu];
+		if(!state->online)
+			continue;
+
+		// The idle thread is included whether it is running or not:
+		if(process == 0)
+		{
+			if(retval < length)
+				get_statistics(&buffer[retval], state->idle_thread, state->current_thread == state->idle_thread
+					? MORDAX_THREAD_STATE_RUNNING : MORDAX_THREAD_STATE_READY);
+			++retval;
+		}
+
+		if(state->current_thread != 0 && state->current_thread != state->idle_thread
+			&& (process == 0 || state->current_thread->parent == process))
+		{
+			if(retval < length)
+				get_statistics(&buffer[retval], state->current_thread, MORDAX_THREAD_STATE_RUNNING);
+			++retval;
+		}
+
+		retval = get_queue_statistics(state->realtime_queue, buffer, length, retval,
+			MORDAX_THREAD_STATE_READY, process);
+		retval = get_queue_statistics(state->throttled_queue, buffer, length, retval,
+			MORDAX_THREAD_STATE_READY, process);
+		retval = get_queue_statistics(state->running_queue, buffer, length, retval,
+			MORDAX_THREAD_STATE_READY, process);
+	}
+
+	// Sleeping threads are reported as blocking:
+	retval = get_queue_statistics(sleeping_queue, buffer, length, retval, MORDAX_THREAD_STATE_BLOCKING, process);
+	return get_queue_statistics(blocking_queue, buffer, length, retval, MORDAX_THREAD_STATE_BLOCKING, process);
+}
+
+struct process * scheduler_get_process(pid_t pid)
+{
+	struct process * retval = 0;
+
+	// Every thread is either running or in one of the queues:
+	for(unsigned int cpu = 0; cpu < CONFIG_MAX_CPUS && retval == 0; ++cpu)
+	{
+		struct scheduler_cpu * state = &scheduler_cpus[cpu];
+		if(state->current_thread != 0 && state->current_thread->parent->pid == pid)
+			retval = state->current_thread->parent;
+		else if((retval = find_process(state->realtime_queue, pid)) == 0
+			&& (retval = find_process(state->throttled_queue, pid)) == 0)
+			retval = find_process(state->running_queue, pid);
+	}
+
+	if(retval == 0)
+		retval = find_process(sleeping_queue, pid);
+	return retval != 0 ? retval : find_process(blocking_queue, pid);
 }
 
 pid_t scheduler_allocate_pid(void)
@@ -199,3 +513,238 @@ void scheduler_free_pid(pid_t pid)
 	number_allocator_free_num(pid_allocator, pid + 1);
 }
 
+static unsigned int select_cpu(struct thread * t)
+{
+	unsigned int retval = cpu_get_id();
+
+	// Real-time threads stay on the processor their bandwidth is reserved on:
+	if(t->period != 0)
+		return t->cpu;
+
+	// Pick the online processor with the fewest threads ready to run,
+	// preferring the current processor:
+	for(unsigned int cpu = 0; cpu < CONFIG_MAX_CPUS; ++cpu)
+	{
+		if(scheduler_cpus[cpu].online && scheduler_cpus[cpu].running_queue->elements
+			< scheduler_cpus[retval].running_queue->elements)
+			retval = cpu;
+	}
+
+	return retval;
+}
+
+static void add_to_cpu(struct thread * t, unsigned int cpu)
+{
+	struct thread * current_thread = scheduler_cpus[cpu].current_thread;
+
+	t->cpu = cpu;
+	t->timestamp = cpu_cycles(cpu);
+
+	if(t->period != 0)
+	{
+		uint64_t now = scheduler_time();
+
+		// Constant bandwidth server wakeup rule; if the remaining budget
+		// cannot be used before the deadline without exceeding the reserved
+		// bandwidth, a new period is started:
+		if(t->deadline <= now || (uint64_t) t->remaining_budget * t->period >= (t->deadline - now) * t->budget)
+		{
+			t->deadline = now + t->period;
+			t->remaining_budget = t->budget;
+		} else if(t->remaining_budget == 0)
+		{
+			insert_by_deadline(scheduler_cpus[cpu].throttled_queue, t);
+			return;
+		}
+
+		insert_by_deadline(scheduler_cpus[cpu].realtime_queue, t);
+	} else {
+		if(t->remaining_quantum == 0)
+			t->remaining_quantum = t->parent->quantum;
+		queue_add_front(scheduler_cpus[cpu].running_queue, t);
+	}
+
+	// Preempt the running thread if the processor is idle or if the new
+	// thread has a higher priority, so the thread does not have to wait for
+	// the next timer tick on that processor. Real-time threads are ordered by
+	// deadline and always have a higher priority than best-effort threads:
+	bool preempt = false;
+	if(current_thread == scheduler_cpus[cpu].idle_thread)
+		preempt = true;
+	else if(current_thread != 0 && t->period != 0)
+		preempt = current_thread->period == 0 || t->deadline < current_thread->deadline;
+	else if(current_thread != 0)
+		preempt = current_thread->period == 0 && t->boost > current_thread->boost;
+
+	if(preempt && scheduler_cpus[cpu].online)
+		scheduler_cpus[cpu].preempt = true;
+}
+
+static bool remove_from_queue(struct queue * queue, struct thread * t)
+{
+	struct queue_node * current = queue->first;
+	while(current != 0)
+	{
+		if(current->data == t)
+		{
+			queue_remove_node(queue, current);
+			return true;
+		}
+
+		current = current->next;
+	}
+
+	return false;
+}
+
+static uint64_t cpu_cycles(unsigned int cpu)
+{
+	struct scheduler_cpu * state = &scheduler_cpus[cpu];
+
+	// The cycle counter of another processor cannot be read, so use the
+	// value from its last reading. This is at most one tick old, as every
+	// processor reads its counter when rescheduling:
+	if(cpu == cpu_get_id())
+	{
+		uint32_t counter = cycles_read();
+		state->cycles += counter - state->cycles_last;
+		state->cycles_last = counter;
+	}
+
+	return state->cycles;
+}
+
+static void stop_running(struct thread * t, bool voluntary)
+{
+	uint64_t now = cpu_cycles(t->cpu);
+	t->runtime += now - t->timestamp;
+	t->timestamp = now;
+
+	if(voluntary)
+		++t->voluntary_switches;
+	else
+		++t->involuntary_switches;
+}
+
+static void get_statistics(struct mordax_thread_statistics * entry, struct thread * t, uint32_t state)
+{
+	entry->pid = t->parent->pid;
+	entry->tid = t->tid;
+	entry->cpu = t->cpu;
+	entry->state = state;
+	entry->runtime = t->runtime;
+	entry->wait_time = t->wait_time;
+	entry->voluntary_switches = t->voluntary_switches;
+	entry->involuntary_switches = t->involuntary_switches;
+
+	// Include the time spent in the current time slice or waiting in the queue:
+	if(state == MORDAX_THREAD_STATE_RUNNING)
+		entry->runtime += cpu_cycles(t->cpu) - t->timestamp;
+	else if(state == MORDAX_THREAD_STATE_READY && t != scheduler_cpus[t->cpu].idle_thread)
+		entry->wait_time += cpu_cycles(t->cpu) - t->timestamp;
+}
+
+static bool remove_from_cpu(struct scheduler_cpu * cpu, struct thread * t)
+{
+	return remove_from_queue(cpu->running_queue, t) || remove_from_queue(cpu->realtime_queue, t)
+		|| remove_from_queue(cpu->throttled_queue, t);
+}
+
+static uint64_t scheduler_time(void)
+{
+	return interval_start + scheduler_timer->get_elapsed();
+}
+
+static void program_timer(uint64_t now, unsigned int interval)
+{
+	interval_start = now;
+	current_interval = interval;
+	scheduler_timer->set_interval(interval);
+	scheduler_timer->start();
+}
+
+static void charge_thread(struct scheduler_cpu * cpu, struct thread * t, uint64_t now)
+{
+	uint64_t used = now - cpu->slice_start;
+	uint32_t * remaining = t->period != 0 ? &t->remaining_budget : &t->remaining_quantum;
+
+	// Time too short to be enforced by the timer counts as used up:
+	if(used + SCHEDULER_MIN_INTERVAL > *remaining)
+		*remaining = 0;
+	else
+		*remaining -= used;
+
+	cpu->slice_start = now;
+}
+
+static void release_throttled(struct scheduler_cpu * cpu, uint64_t now)
+{
+	while(cpu->throttled_queue->first != 0)
+	{
+		struct thread * t = cpu->throttled_queue->first->data;
+		if(t->deadline > now)
+			break;
+
+		queue_remove_front(cpu->throttled_queue, (void **) &t);
+		t->deadline += t->period;
+		if(t->deadline <= now)
+			t->deadline = now + t->period;
+		t->remaining_budget = t->budget;
+		insert_by_deadline(cpu->realtime_queue, t);
+	}
+}
+
+static void release_sleeping(uint64_t now)
+{
+	while(sleeping_queue->first != 0)
+	{
+		struct thread * t = sleeping_queue->first->data;
+		if(t->wakeup_time > now)
+			break;
+
+		queue_remove_front(sleeping_queue, (void **) &t);
+		add_to_cpu(t, select_cpu(t));
+	}
+}
+
+static void insert_by_deadline(struct queue * queue, struct thread * t)
+{
+	struct queue_node * node = queue->first;
+	while(node != 0 && ((struct thread *) node->data)->deadline <= t->deadline)
+		node = node->next;
+	queue_insert_before(queue, node, t);
+}
+
+static uint32_t utilization(uint32_t budget, uint32_t period)
+{
+	return ((uint64_t) budget * 1000000) / period;
+}
+
+static struct process * find_process(struct queue * queue, pid_t pid)
+{
+	for(struct queue_node * node = queue->first; node != 0; node = node->next)
+	{
+		struct thread * t = node->data;
+		if(t->parent->pid == pid)
+			return t->parent;
+	}
+
+	return 0;
+}
+
+static unsigned int get_queue_statistics(struct queue * queue, struct mordax_thread_statistics * buffer,
+	unsigned int length, unsigned int count, uint32_t state, struct process * process)
+{
+	for(struct queue_node * node = queue->first; node != 0; node = node->next)
+	{
+		struct thread * t = node->data;
+		if(process != 0 && t->parent != process)
+			continue;
+
+		if(count < length)
+			get_statistics(&buffer[count], t, state);
+		++count;
+	}
+
+	return count;
+}
@@ -5,18 +5,72 @@
 #ifndef MORDAX_SCHEDULER_H
 #define MORDAX_SCHEDULER_H
 
+#include "queue.h"
+#include "smp.h"
 #include "thread.h"
+#include "api/thread.h"
 #include "api/types.h"
 #include "drivers/timer/timer.h"
 
 /**
  * @defgroup scheduler Scheduler Functionality
- * @todo Support SMP.
  * @{
  */
 
-/** The currently active thread. */
-extern struct thread * active_thread;
+/**
+ * Scheduler state for a processor. Each processor has its own queues of
+ * threads that are ready to run and its own idle thread.
+ *
+ * Real-time threads are scheduled earliest deadline first using constant
+ * bandwidth servers; each real-time thread may use `budget` microseconds of
+ * processor time in every `period`. A real-time thread that has used up its
+ * budget is throttled until its deadline, when the budget is replenished.
+ * Best-effort threads in the running queue only run when no real-time
+ * thread is ready.
+ */
+struct scheduler_cpu
+{
+	struct queue * realtime_queue;	//< Real-time threads ready to run, sorted by deadline.
+	struct queue * throttled_queue;	//< Real-time threads waiting for a new budget, sorted by deadline.
+	uint32_t realtime_utilization;	//< Bandwidth reserved by real-time threads, in parts per million.
+	struct queue * running_queue;	//< Best-effort threads ready to run on this processor.
+	struct thread * current_thread;	//< Thread currently running on this processor.
+	struct thread * idle_thread;	//< Thread to run when no other thread is ready.
+	bool online;			//< Whether the processor runs threads.
+	bool preempt;			//< Whether the current thread should be preempted.
+	uint64_t cycles;		//< Cycle count at the last reading of the cycle counter.
+	uint32_t cycles_last;		//< Last value read from the cycle counter.
+	uint64_t slice_start;		//< Time the running thread was last charged for its processor time.
+};
+
+/** Size of the stack of the idle threads. */
+#define SCHEDULER_IDLE_STACK_SIZE	1024
+
+/** Default length of a time slice, in microseconds. */
+#define SCHEDULER_DEFAULT_QUANTUM	100000
+/** Shortest time slice a process can use, in microseconds. */
+#define SCHEDULER_MIN_QUANTUM		1000
+/**
+ * Longest time slice a process can use, in microseconds. This is also the
+ * longest interval the scheduler timer is programmed with.
+ */
+#define SCHEDULER_MAX_QUANTUM		1000000
+
+/** Maximum bandwidth reserved for real-time threads on a processor, in parts per million. */
+#define SCHEDULER_REALTIME_MAX_UTILIZATION	900000
+/** Shortest allowed real-time period, in microseconds. */
+#define SCHEDULER_REALTIME_MIN_PERIOD		1000
+
+/** Wakeup priority boost for threads released by an interrupt. */
+#define SCHEDULER_BOOST_IRQ	2
+/** Wakeup priority boost for threads released by an IPC operation. */
+#define SCHEDULER_BOOST_IPC	1
+
+/** Scheduler state for each processor. */
+extern struct scheduler_cpu scheduler_cpus[CONFIG_MAX_CPUS];
+
+/** The currently active thread on the current processor. */
+#define active_thread	(scheduler_cpus[cpu_get_id()].current_thread)
 
 /** The currently active process. */
 #define active_process	(active_thread != 0 ? active_thread->parent : 0)
@@ -51,17 +105,92 @@ struct thread * scheduler_remove_thread(struct thread * t);
  */
 void scheduler_move_thread_to_blocking(struct thread * t);
 
+/**
+ * Puts a thread to sleep. The thread is moved to the queue of running
+ * threads again when the scheduler runs after the sleep time has passed.
+ * @param t the thread to put to sleep, which must be the thread running on
+ *          the current processor.
+ * @param microseconds the minimum time to sleep, in microseconds.
+ */
+void scheduler_sleep_thread(struct thread * t, uint32_t microseconds);
+
 /**
  * Moves a thread to the queue of running threads.
  * @param t the thread to move.
  */
 void scheduler_move_thread_to_running(struct thread * t);
 
+/**
+ * Moves a thread to the queue of running threads and gives it a temporary
+ * priority boost. A boosted thread preempts the thread running on its
+ * processor if that thread has a lower boost, and the boost decays by one
+ * for every time slice the thread uses up.
+ * @param t the thread to wake up.
+ * @param boost the priority boost to give the thread.
+ */
+void scheduler_wake_thread(struct thread * t, unsigned int boost);
+
+/**
+ * Sets the real-time parameters of a thread. The thread is admitted to the
+ * real-time class only if the bandwidth it requests, together with the
+ * bandwidth of the other real-time threads on its processor, does not exceed
+ * `SCHEDULER_REALTIME_MAX_UTILIZATION`.
+ * @param t the thread to change the parameters of.
+ * @param budget the processor time the thread may use in each period, in
+ *               microseconds, or 0 to make the thread a best-effort thread.
+ * @param period the real-time period, in microseconds.
+ * @return 0 if successful, `-EINVAL` if the parameters are invalid or
+ *         `-EBUSY` if the thread could not be admitted.
+ */
+int scheduler_set_realtime(struct thread * t, uint32_t budget, uint32_t period);
+
 /**
  * Forces the scheduler to do a scheduling pass.
  */
 void scheduler_reschedule();
 
+/**
+ * Checks if the thread running on the current processor should be preempted,
+ * because a thread with a higher priority has been woken up or because the
+ * processor is idle and a thread has become ready to run.
+ * @return `true` if the scheduler should be run, `false` otherwise.
+ */
+bool scheduler_preemption_pending(void);
+
+/**
+ * Gets the current time.
+ * @return the time in microseconds since the scheduler was started, or 0 if
+ *         the scheduler has not been initialized.
+ */
+uint64_t scheduler_get_time(void);
+
+/**
+ * Gets the cycle count of the current processor. Unlike the cycle counter
+ * itself, the returned count does not wrap around.
+ * @return the number of cycles since the scheduler was initialized.
+ */
+uint64_t scheduler_get_cycles(void);
+
+/**
+ * Gets scheduler statistics for the threads in the system, including the
+ * idle threads, or for the threads of a single process.
+ * @param buffer buffer to store the statistics in.
+ * @param length number of entries that fit in the buffer.
+ * @param process the process to get statistics for, or 0 to get statistics
+ *                for all threads.
+ * @return the number of threads found. If this is larger than `length`,
+ *         only the first `length` entries are stored.
+ */
+unsigned int scheduler_get_statistics(struct mordax_thread_statistics * buffer, unsigned int length,
+	struct process * process);
+
+/**
+ * Finds a process by its PID.
+ * @param pid the PID of the process.
+ * @return the process or 0 if no process with the PID has any threads.
+ */
+struct process * scheduler_get_process(pid_t pid);
+
 /**
  * Allocates a new process identifier (PID) for a thread.
  * @return the new process identifier, or -1 if no PID can be allocated.
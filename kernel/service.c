@@ -5,33 +5,64 @@
 #include "context.h"
 #include "debug.h"
 #include "mm.h"
-#include "rbtree.h"
 #include "scheduler.h"
 #include "service.h"
 #include "utils.h"
+#include "waitset.h"
 
 #include "api/errno.h"
 
-// Table of all registered services:
-static struct rbtree * service_table;
+// Initial number of buckets in the service table, must be a power of two:
+#define SERVICE_TABLE_INITIAL_SIZE	16
 
+// Hash table of all registered services. The table is doubled in size when
+// the number of services exceeds the number of buckets:
+static struct service ** service_table;
+static unsigned int service_table_size, num_services;
+
+// Thread listening on a service:
+struct service_listener
+{
+	struct thread * thread;
+	mordax_resource_t * sockets;	// Accept buffer, 0 if the thread called service_listen.
+};
+
+// Calculates the hash of a service name:
+static uint32_t hash_name(const char * name);
+// Finds the link pointing to a service in the service table, or to the end
+// of the bucket if no service with the specified name exists:
+static struct service ** find_service(const char * name, uint32_t hash);
+// Doubles the number of buckets in the service table:
+static void expand_table(void);
 // Frees a service structure:
 static void service_free(struct service * svc);
+// Blocks a thread listening on a service:
+static void add_listener(struct service * svc, struct thread * thread, mordax_resource_t * sockets);
+// Connects the first client in the backlog, returns the server socket identifier:
+static mordax_resource_t accept_client(struct service * svc, struct thread * listener);
+// Releases a thread blocking on a service with an error:
+static void release_listener(struct service_listener * listener);
+static void release_client(struct thread * client);
 
 void services_initialize(void)
 {
-	service_table = rbtree_new((rbtree_key_compare_func) strcmp, mm_free,
-		(rbtree_key_duplicate_func) strdup, (rbtree_data_free_func) service_free);
+	service_table_size = SERVICE_TABLE_INITIAL_SIZE;
+	service_table = mm_allocate(service_table_size * sizeof(struct service *),
+		MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
+	memclr(service_table, service_table_size * sizeof(struct service *));
+	num_services = 0;
 }
 
 struct service * service_lookup(const char * name)
 {
-	return rbtree_get_value(service_table, name);
+	return *find_service(name, hash_name(name));
 }
 
 struct service * service_create(const char * name, struct process * owner)
 {
-	if(rbtree_key_exists(service_table, name))
+	uint32_t hash = hash_name(name);
+	struct service ** link = find_service(name, hash);
+	if(*link != 0)
 		return 0;
 
 	struct service * retval = mm_allocate(sizeof(struct service), MM_DEFAULT_ALIGNMENT,
@@ -40,46 +71,69 @@ struct service * service_create(const char * name, struct process * owner)
 		MM_MEM_NORMAL);
 	memcpy(retval->name, name, strlen(name) + 1);
 	retval->owner = owner;
-	retval->listening_thread = 0;
+	retval->listeners = queue_new();
 	retval->backlog = queue_new();
+	retval->backlog_limit = MORDAX_SERVICE_DEFAULT_BACKLOG;
+	retval->waitset = 0;
+
+	retval->hash = hash;
+	retval->next = 0;
+	*link = retval;
 
-	rbtree_insert(service_table, name, retval);
+	if(++num_services > service_table_size)
+		expand_table();
 	return retval;
 }
 
 void service_destroy(struct service * svc)
 {
-	// Causes service_free to be called on the service if found:
-	rbtree_delete(service_table, svc->name);
+	struct service ** link = find_service(svc->name, svc->hash);
+	if(*link == svc)
+	{
+		*link = svc->next;
+		--num_services;
+		service_free(svc);
+	}
 }
 
-int service_listen(struct service * svc, struct thread * listener, 
-	struct socket ** server_socket, bool * blocking)
+int service_set_backlog(struct service * svc, unsigned int limit)
 {
-	*blocking = false;
-	*server_socket = 0;
+	if(limit > MORDAX_SERVICE_MAX_BACKLOG)
+		return -EINVAL;
 
-	if(svc->listening_thread != 0)
-		return -EBUSY;
+	svc->backlog_limit = limit;
+	return 0;
+}
+
+int service_listen(struct service * svc, struct thread * listener, bool * blocking)
+{
+	*blocking = false;
 
 	if(svc->backlog->elements > 0)
-	{
-		struct thread * client_thread = 0;
-		if(!queue_remove_front(svc->backlog, (void **) &client_thread))
-			return -EINTERNAL;
-		struct socket * client_socket = socket_create(client_thread);
+		return accept_client(svc, listener);
+	else {
+		add_listener(svc, listener, 0);
+		*blocking = true;
+		return 0;
+	}
+}
 
-		*server_socket = socket_create(listener);
-		socket_connect(client_socket, *server_socket);
+int service_accept(struct service * svc, struct thread * listener, mordax_resource_t * sockets,
+	unsigned int length, bool * blocking)
+{
+	*blocking = false;
 
-		mordax_resource_t client_retval = process_add_resource(client_thread->parent,
-			PROCESS_RESOURCE_SOCKET, client_socket);
-		context_set_syscall_retval(client_thread->context, (void *) client_retval);
-		scheduler_move_thread_to_running(client_thread);
+	if(length == 0)
+		return -EINVAL;
 
-		return 0;
+	if(svc->backlog->elements > 0)
+	{
+		unsigned int retval = 0;
+		while(retval < length && svc->backlog->elements > 0)
+			sockets[retval++] = accept_client(svc, listener);
+		return retval;
 	} else {
-		svc->listening_thread = listener;
+		add_listener(svc, listener, sockets);
 		*blocking = true;
 		return 0;
 	}
@@ -91,38 +145,132 @@ int service_connect(struct service * svc, struct thread * connecting_thread,
 	*blocking = false;
 	*client_socket = 0;
 
-	if(svc->listening_thread != 0)
+	struct service_listener * listener = 0;
+	if(queue_remove_front(svc->listeners, (void **) &listener))
 	{
-		struct socket * server_socket  = socket_create(svc->listening_thread);
+		struct socket * server_socket  = socket_create(listener->thread);
 		*client_socket = socket_create(connecting_thread);
 
 		socket_connect(*client_socket, server_socket);
 
 		// Wake up the listening thread and return the new socket:
-		mordax_resource_t server_retval = process_add_resource(svc->listening_thread->parent,
+		mordax_resource_t server_retval = process_add_resource(listener->thread->parent,
 			PROCESS_RESOURCE_SOCKET, server_socket);
-		context_set_syscall_retval(svc->listening_thread->context, (void *) server_retval);
-		scheduler_move_thread_to_running(svc->listening_thread);
-		svc->listening_thread = 0;
+		if(listener->sockets != 0)
+		{
+			memcpy_p(listener->sockets, listener->thread->parent, &server_retval,
+				connecting_thread->parent, sizeof(mordax_resource_t));
+			context_set_syscall_retval(listener->thread->context, (void *) 1);
+		} else
+			context_set_syscall_retval(listener->thread->context, (void *) server_retval);
+		scheduler_move_thread_to_running(listener->thread);
+		mm_free(listener);
 
 		return 0;
-	} else {
+	} else if(svc->backlog->elements >= svc->backlog_limit)
+		return -ECONNREFUSED;
+	else {
 		queue_add_back(svc->backlog, connecting_thread);
+		waitset_notify(svc->waitset, MORDAX_WAITSET_READY);
 		*blocking = true;
 		return 0;
 	}
 }
 
-static void service_free(struct service * svc)
+static uint32_t hash_name(const char * name)
+{
+	// 32-bit FNV-1a hash:
+	uint32_t retval = 2166136261u;
+	while(*name != 0)
+	{
+		retval ^= (uint8_t) *name++;
+		retval *= 16777619u;
+	}
+
+	return retval;
+}
+
+static struct service ** find_service(const char * name, uint32_t hash)
 {
-	// If a thread is currently listening on this socket, release it with an error:
-	if(svc->listening_thread != 0)
+	struct service ** link = &service_table[hash & (service_table_size - 1)];
+	while(*link != 0 && ((*link)->hash != hash || strcmp((*link)->name, name) != 0))
+		link = &(*link)->next;
+	return link;
+}
+
+static void expand_table(void)
+{
+	unsigned int new_size = service_table_size * 2;
+	struct service ** new_table = mm_allocate(new_size * sizeof(struct service *),
+		MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
+	if(new_table == 0)
+		return;
+	memclr(new_table, new_size * sizeof(struct service *));
+
+	for(unsigned int i = 0; i < service_table_size; ++i)
 	{
-		context_set_syscall_retval(svc->listening_thread->context, (void *) -ECANCELED);
-		scheduler_move_thread_to_running(svc->listening_thread);
+		struct service * current = service_table[i];
+		while(current != 0)
+		{
+			struct service * next = current->next;
+			current->next = new_table[current->hash & (new_size - 1)];
+			new_table[current->hash & (new_size - 1)] = current;
+			current = next;
+		}
 	}
 
+	mm_free(service_table);
+	service_table = new_table;
+	service_table_size = new_size;
+}
+
+static void service_free(struct service * svc)
+{
+	// Release threads blocking on the service with an error:
+	queue_free(svc->listeners, (queue_data_free_func) release_listener);
+	queue_free(svc->backlog, (queue_data_free_func) release_client);
+
+	waitset_unwatch(&svc->waitset);
 	mm_free(svc->name);
 	mm_free(svc);
 }
 
+static void add_listener(struct service * svc, struct thread * thread, mordax_resource_t * sockets)
+{
+	struct service_listener * listener = mm_allocate(sizeof(struct service_listener),
+		MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
+	listener->thread = thread;
+	listener->sockets = sockets;
+	queue_add_back(svc->listeners, listener);
+}
+
+static mordax_resource_t accept_client(struct service * svc, struct thread * listener)
+{
+	struct thread * client_thread = 0;
+	queue_remove_front(svc->backlog, (void **) &client_thread);
+
+	struct socket * client_socket = socket_create(client_thread);
+	struct socket * server_socket = socket_create(listener);
+	socket_connect(client_socket, server_socket);
+
+	mordax_resource_t client_retval = process_add_resource(client_thread->parent,
+		PROCESS_RESOURCE_SOCKET, client_socket);
+	context_set_syscall_retval(client_thread->context, (void *) client_retval);
+	scheduler_move_thread_to_running(client_thread);
+
+	return process_add_resource(listener->parent, PROCESS_RESOURCE_SOCKET, server_socket);
+}
+
+static void release_listener(struct service_listener * listener)
+{
+	context_set_syscall_retval(listener->thread->context, (void *) -ECANCELED);
+	scheduler_move_thread_to_running(listener->thread);
+	mm_free(listener);
+}
+
+static void release_client(struct thread * client)
+{
+	context_set_syscall_retval(client->context, (void *) -ECANCELED);
+	scheduler_move_thread_to_running(client);
+}
+
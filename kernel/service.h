@@ -10,17 +10,35 @@
 #include "socket.h"
 #include "thread.h"
 
+#include "api/service.h"
+#include "api/types.h"
+
 /**
  * @defgroup service IPC Service Support
  * @{
  */
 
+struct waitset_entry;
+
+/**
+ * IPC service structure.
+ * Any number of threads can listen on a service. Connecting clients are
+ * handed to the listening threads in the order they started listening, and
+ * are put in the backlog of the service if no thread is listening.
+ */
 struct service
 {
 	char * name;
+	uint32_t hash;
+	struct service * next;	//< Next service in the same bucket of the service table.
+
 	struct process * owner;
-	struct thread * listening_thread;
+	struct queue * listeners;
 	struct queue * backlog;
+	unsigned int backlog_limit;
+
+	// Wait set registration, see waitset.h:
+	struct waitset_entry * waitset;
 };
 
 /**
@@ -53,20 +71,44 @@ struct service * service_create(const char * name, struct process * owner)
 void service_destroy(struct service * svc);
 
 /**
- * Listens on a service.
+ * Sets the maximum number of clients waiting in the backlog of a service.
+ * Clients already in the backlog are kept if the limit is reduced.
+ * @param svc the service.
+ * @param limit the new backlog limit.
+ * @return 0 if successful or a negative error code on failure.
+ */
+int service_set_backlog(struct service * svc, unsigned int limit);
+
+/**
+ * Listens on a service. If a client is waiting in the backlog, the connection
+ * is established immediately, otherwise the listener is set as blocking until
+ * a client connects.
  * @param svc the service to listen on.
  * @param listener the thread listening on the service.
- * @param server_socket a pointer used to return the server socket if a connection
- *                      was waiting when `service_listen` was called.
  * @param blocking a pointer to a variable that is set to `true` if the listener thread
  *                 should be moved to the blocking queue.
- * @return 0 if no error occurs, in which case `blocking` and `server_socket`
- *         should be used as return values, of less than 0 if an error occurs. In
- *         this case, the error code can be returned directly to the calling thread
+ * @return the identifier of the server socket if a connection was established,
+ *         0 if the listener should block, or a negative error code. In both
+ *         cases, the value can be returned directly to the calling thread
  *         as a syscall return value.
  */
-int service_listen(struct service * svc, struct thread * listener,
-	struct socket ** server_socket, bool * blocking);
+int service_listen(struct service * svc, struct thread * listener, bool * blocking);
+
+/**
+ * Accepts several connections to a service. All clients waiting in the
+ * backlog, up to the specified number, are connected. If no clients are
+ * waiting, the listener is set as blocking until a client connects.
+ * @param svc the service to accept connections on.
+ * @param listener the thread accepting connections.
+ * @param sockets array, in the address space of the listener, where the
+ *                identifiers of the server sockets are stored.
+ * @param length length of the array.
+ * @param blocking a pointer to a variable that is set to `true` if the listener thread
+ *                 should be moved to the blocking queue.
+ * @return the number of connections accepted or a negative error code.
+ */
+int service_accept(struct service * svc, struct thread * listener, mordax_resource_t * sockets,
+	unsigned int length, bool * blocking);
 
 /**
  * Connects to a service.
@@ -79,7 +121,8 @@ int service_listen(struct service * svc, struct thread * listener,
  * @return 0 if no error occurs, in which case `blocking` and `client_socket` is
  *         the actual return values. A value less than 0 indicates that an error
  *         has occured, and the error code can be returned directly to the calling
- *         thread as syscall return value.
+ *         thread as syscall return value. `-ECONNREFUSED` is returned if the
+ *         backlog of the service is full.
  */
 int service_connect(struct service * svc, struct thread * connecting_thread,
 	struct socket ** client_socket, bool * blocking);
@@ -0,0 +1,68 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_SMP_H
+#define MORDAX_SMP_H
+
+#include "api/types.h"
+
+#ifndef CONFIG_MAX_CPUS
+#error "maximum number of processors not set, define CONFIG_MAX_CPUS with the proper number"
+#endif
+
+/**
+ * @defgroup smp Multiprocessor Support
+ * Per-processor state and locking of the shared kernel state. Only the boot
+ * processor is started, so setting CONFIG_MAX_CPUS above 1 does not make the
+ * kernel use more processors.
+ * @{
+ */
+
+/** Spinlock type. A spinlock is unlocked when its value is 0. */
+typedef volatile uint32_t spinlock_t;
+
+/** Initial value of an unlocked spinlock. */
+#define SPINLOCK_UNLOCKED	0
+
+/**
+ * Lock protecting the shared kernel state. It is taken when entering
+ * the kernel from an exception and released when returning to the
+ * interrupted thread.
+ */
+extern spinlock_t kernel_lock;
+
+#if CONFIG_MAX_CPUS > 1
+
+/**
+ * Gets the index of the processor the caller is running on.
+ * @return the index of the current processor.
+ */
+unsigned int cpu_get_id(void);
+
+/**
+ * Acquires a spinlock, busy-waiting until it becomes available.
+ * @param lock the lock to acquire.
+ */
+void spinlock_lock(spinlock_t * lock);
+
+/**
+ * Releases a spinlock.
+ * @param lock the lock to release.
+ */
+void spinlock_unlock(spinlock_t * lock);
+
+#else
+
+// On uniprocessor systems, interrupts are disabled while running kernel
+// code, so no locking is needed:
+#define cpu_get_id()		0
+#define spinlock_lock(lock)	((void) (lock))
+#define spinlock_unlock(lock)	((void) (lock))
+
+#endif
+
+/** @} */
+
+#endif
+
@@ -7,9 +7,34 @@
 #include "scheduler.h"
 #include "socket.h"
 #include "utils.h"
+#include "waitset.h"
 
 #include "api/errno.h"
 
+// Message in the message queue of a socket:
+struct socket_message
+{
+	size_t length;
+	char data[];
+};
+
+// Gets the total length of a list of segments:
+static int iov_length(const struct mordax_iovec * iov, unsigned int count);
+// Copies data between two lists of segments, returns the number of bytes copied:
+static size_t iov_copy(const struct mordax_iovec * dest, unsigned int dest_count, struct process * dest_proc,
+	const struct mordax_iovec * src, unsigned int src_count, struct process * src_proc);
+// Stores the message buffer of a thread that is about to block on a socket:
+static void set_blocking_details(struct socket * sock, const struct mordax_iovec * iov,
+	unsigned int count, size_t length);
+// Wakes up a thread blocking on a socket with the specified return value:
+static void release_thread(struct thread ** t, int retval);
+// Copies a message into the message queue of a socket, returns 0 or -ENOMEM:
+static int queue_message(struct socket * sock, const struct mordax_iovec * iov, unsigned int count,
+	size_t length, struct process * src_proc, struct process * active_proc);
+// Moves the message of a thread blocking while sending to a socket into the
+// message queue of the socket if the queue has room for it:
+static void queue_blocking_sender(struct socket * sock, struct process * active_proc);
+
 struct socket * socket_create(struct thread * owner)
 {
 	struct socket * retval = mm_allocate(sizeof(struct socket),
@@ -17,6 +42,7 @@ struct socket * socket_create(struct thread * owner)
 	memclr(retval, sizeof(struct socket));
 
 	retval->owner = owner;
+	retval->messages = queue_new();
 
 	return retval;
 }
@@ -24,27 +50,24 @@ struct socket * socket_create(struct thread * owner)
 void socket_destroy(struct socket * sock)
 {
 	// Remove blocking threads:
-	if(sock->blocking_receiver)
-	{
-		context_set_syscall_retval(sock->blocking_receiver->context, (void *) -ENOTCONN);
-		scheduler_move_thread_to_running(sock->blocking_receiver);
-	}
+	release_thread(&sock->blocking_receiver, -ENOTCONN);
+	release_thread(&sock->blocking_sender, -ENOTCONN);
+	release_thread(&sock->blocking_waiter, -ENOTCONN);
 
-	if(sock->blocking_sender)
-	{
-		context_set_syscall_retval(sock->blocking_sender->context, (void *) -ENOTCONN);
-		scheduler_move_thread_to_running(sock->blocking_sender);
-	}
+	waitset_unwatch(&sock->waitset);
+	queue_free(sock->messages, mm_free);
 
-	if(sock->blocking_waiter)
+	// Disconnect from the endpoint. Messages already queued on the endpoint
+	// can still be received after the socket has been closed:
+	if(sock->endpoint != 0)
 	{
-		context_set_syscall_retval(sock->blocking_waiter->context, (void *) -ENOTCONN);
-		scheduler_move_thread_to_running(sock->blocking_waiter);
-	}
+		release_thread(&sock->endpoint->blocking_receiver, -ENOTCONN);
+		release_thread(&sock->endpoint->blocking_sender, -ENOTCONN);
+		release_thread(&sock->endpoint->blocking_waiter, -ENOTCONN);
 
-	// Disconnect from the endpoint:
-	if(sock->endpoint != 0)
 		sock->endpoint->endpoint = 0;
+		waitset_notify(sock->endpoint->waitset, MORDAX_WAITSET_HANGUP);
+	}
 	mm_free(sock);
 }
 
@@ -55,10 +78,24 @@ bool socket_connect(struct socket * a, struct socket * b)
 	return true;
 }
 
+int socket_set_queue_depth(struct socket * sock, unsigned int depth, struct process * active_proc)
+{
+	if(depth > MORDAX_SOCKET_MAX_QUEUE_DEPTH)
+		return -EINVAL;
+
+	sock->queue_depth = depth;
+	if(sock->endpoint != 0 && sock->endpoint->blocking_sender != 0)
+		queue_blocking_sender(sock, active_proc);
+	return 0;
+}
+
 int socket_wait(struct socket * sock, struct thread * waiting_thread, bool * block)
 {
 	*block = false;
 
+	if(sock->messages->elements > 0)
+		return ((struct socket_message *) sock->messages->first->data)->length;
+
 	if(sock->endpoint == 0)
 		return -ENOTCONN;
 	if(sock->endpoint->blocking_receiver != 0)
@@ -74,71 +111,214 @@ int socket_wait(struct socket * sock, struct thread * waiting_thread, bool * blo
 }
 
 int socket_receive(struct socket * sock, struct thread * receiving_thread,
-	void * buffer, size_t length, bool * block)
+	const struct mordax_iovec * iov, unsigned int count, unsigned int flags, bool * block)
 {
 	*block = false;
 
+	int length = iov_length(iov, count);
+	if(length < 0)
+		return length;
+
+	if(sock->messages->elements > 0)
+	{
+		struct socket_message * message = 0;
+		if(!queue_remove_front(sock->messages, (void **) &message))
+			return -EINTERNAL;
+
+		struct mordax_iovec message_iov = { message->data, message->length };
+		size_t retval = iov_copy(iov, count, receiving_thread->parent, &message_iov, 1,
+			receiving_thread->parent);
+		mm_free(message);
+
+		// Make room for a thread that is blocking because the queue was full:
+		if(sock->endpoint != 0 && sock->endpoint->blocking_sender != 0)
+			queue_blocking_sender(sock, receiving_thread->parent);
+		return retval;
+	}
+
 	if(sock->endpoint == 0)
 		return -ENOTCONN;
-	if(length > CONFIG_IPC_BUFFER_LENGTH)
-		return -E2BIG;
 	if(sock->endpoint->blocking_receiver != 0 || sock->endpoint->blocking_waiter)
 		return -EBUSY;
 
 	if(sock->endpoint->blocking_sender != 0)
 	{
-		memcpy_p(buffer, receiving_thread->parent, sock->endpoint->blocking_details.buffer,
-			sock->endpoint->blocking_sender->parent, min(sock->endpoint->blocking_details.length, length));
-		scheduler_move_thread_to_running(sock->endpoint->blocking_sender);
-		context_set_syscall_retval(sock->endpoint->blocking_sender->context,
-			(void *) min(length, sock->endpoint->blocking_details.length));
-		sock->endpoint->blocking_sender = 0;
-		return min(length, sock->endpoint->blocking_details.length);
-	} else {
+		struct socket * sender = sock->endpoint;
+		size_t retval = iov_copy(iov, count, receiving_thread->parent, sender->blocking_details.iov,
+			sender->blocking_details.count, sender->blocking_sender->parent);
+		scheduler_wake_thread(sender->blocking_sender, SCHEDULER_BOOST_IPC);
+		context_set_syscall_retval(sender->blocking_sender->context, (void *) retval);
+		sender->blocking_sender = 0;
+		return retval;
+	} else if(flags & MORDAX_SOCKET_NONBLOCK)
+		return -EWOULDBLOCK;
+	else {
 		sock->blocking_receiver = receiving_thread;
-		sock->blocking_details.buffer = (void *) buffer;
-		sock->blocking_details.length = length;
+		set_blocking_details(sock, iov, count, length);
 		*block = true;
 		return 0;
 	}
 }
 
 int socket_send(struct socket * sock, struct thread * sending_thread,
-	const void * buffer, size_t length, bool * block)
+	const struct mordax_iovec * iov, unsigned int count, unsigned int flags, bool * block)
 {
 	*block = false;
 
 	if(sock->endpoint == 0)
 		return -ENOTCONN;
-	if(length > CONFIG_IPC_BUFFER_LENGTH)
-		return -E2BIG;
-	if(sock->endpoint->blocking_sender != 0)
+
+	int length = iov_length(iov, count);
+	if(length < 0)
+		return length;
+	if(sock->blocking_sender != 0)
 		return -EBUSY;
 
 	if(sock->endpoint->blocking_receiver != 0)
 	{
-		memcpy_p(sock->endpoint->blocking_details.buffer, sock->endpoint->blocking_receiver->parent,
-			(void *) buffer, sending_thread->parent, min(length, sock->endpoint->blocking_details.length));
-		scheduler_move_thread_to_running(sock->endpoint->blocking_receiver);
-		context_set_syscall_retval(sock->endpoint->blocking_receiver->context,
-			(void *) min(length, sock->endpoint->blocking_details.length));
-		sock->endpoint->blocking_receiver = 0;
+		struct socket * receiver = sock->endpoint;
+		size_t retval = iov_copy(receiver->blocking_details.iov, receiver->blocking_details.count,
+			receiver->blocking_receiver->parent, iov, count, sending_thread->parent);
+		scheduler_wake_thread(receiver->blocking_receiver, SCHEDULER_BOOST_IPC);
+		context_set_syscall_retval(receiver->blocking_receiver->context, (void *) retval);
+		receiver->blocking_receiver = 0;
 		return length;
-	} else {
+	} else if(sock->endpoint->messages->elements < sock->endpoint->queue_depth)
+	{
+		int retval = queue_message(sock->endpoint, iov, count, length, sending_thread->parent,
+			sending_thread->parent);
+		return retval != 0 ? retval : length;
+	} else if(flags & MORDAX_SOCKET_NONBLOCK)
+		return -EWOULDBLOCK;
+	else if(sock->endpoint->blocking_sender != 0)
+		return -EBUSY;
+	else {
 		sock->blocking_sender = sending_thread;
-		sock->blocking_details.buffer = (void *) buffer;
-		sock->blocking_details.length = length;
+		set_blocking_details(sock, iov, count, length);
 		*block = true;
 
 		// If a thread is waiting for a message, release it with the size of the message:
 		if(sock->endpoint->blocking_waiter != 0)
 		{
-			scheduler_move_thread_to_running(sock->endpoint->blocking_waiter);
+			scheduler_wake_thread(sock->endpoint->blocking_waiter, SCHEDULER_BOOST_IPC);
 			context_set_syscall_retval(sock->endpoint->blocking_waiter->context, (void *) length);
 			sock->endpoint->blocking_waiter = 0;
 		}
 
+		waitset_notify(sock->endpoint->waitset, MORDAX_WAITSET_READY);
 		return 0;
 	}
 }
 
+static int iov_length(const struct mordax_iovec * iov, unsigned int count)
+{
+	if(count > MORDAX_SOCKET_MAX_IOV)
+		return -EINVAL;
+
+	size_t retval = 0;
+	for(unsigned int i = 0; i < count; ++i)
+	{
+		if(iov[i].length > CONFIG_IPC_BUFFER_LENGTH - retval)
+			return -E2BIG;
+		retval += iov[i].length;
+	}
+
+	return retval;
+}
+
+static size_t iov_copy(const struct mordax_iovec * dest, unsigned int dest_count, struct process * dest_proc,
+	const struct mordax_iovec * src, unsigned int src_count, struct process * src_proc)
+{
+	size_t retval = 0, dest_offset = 0, src_offset = 0;
+	unsigned int d = 0, s = 0;
+
+	while(d < dest_count && s < src_count)
+	{
+		size_t length = min(dest[d].length - dest_offset, src[s].length - src_offset);
+		memcpy_p((char *) dest[d].base + dest_offset, dest_proc,
+			(char *) src[s].base + src_offset, src_proc, length);
+
+		retval += length;
+		dest_offset += length;
+		src_offset += length;
+
+		if(dest_offset == dest[d].length)
+		{
+			++d;
+			dest_offset = 0;
+		}
+
+		if(src_offset == src[s].length)
+		{
+			++s;
+			src_offset = 0;
+		}
+	}
+
+	return retval;
+}
+
+static void set_blocking_details(struct socket * sock, const struct mordax_iovec * iov,
+	unsigned int count, size_t length)
+{
+	memcpy(sock->blocking_details.iov, iov, count * sizeof(struct mordax_iovec));
+	sock->blocking_details.count = count;
+	sock->blocking_details.length = length;
+}
+
+static void release_thread(struct thread ** t, int retval)
+{
+	if(*t != 0)
+	{
+		context_set_syscall_retval((*t)->context, (void *) retval);
+		scheduler_move_thread_to_running(*t);
+		*t = 0;
+	}
+}
+
+static int queue_message(struct socket * sock, const struct mordax_iovec * iov, unsigned int count,
+	size_t length, struct process * src_proc, struct process * active_proc)
+{
+	struct socket_message * message = mm_allocate(sizeof(struct socket_message) + length,
+		MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
+	if(message == 0)
+		return -ENOMEM;
+
+	struct mordax_iovec message_iov = { message->data, length };
+	message->length = length;
+	iov_copy(&message_iov, 1, active_proc, iov, count, src_proc);
+	queue_add_back(sock->messages, message);
+
+	// If a thread is waiting for a message, release it with the size of the
+	// first message in the queue:
+	if(sock->blocking_waiter != 0)
+	{
+		struct socket_message * first = sock->messages->first->data;
+		scheduler_wake_thread(sock->blocking_waiter, SCHEDULER_BOOST_IPC);
+		context_set_syscall_retval(sock->blocking_waiter->context, (void *) first->length);
+		sock->blocking_waiter = 0;
+	}
+
+	waitset_notify(sock->waitset, MORDAX_WAITSET_READY);
+	return 0;
+}
+
+static void queue_blocking_sender(struct socket * sock, struct process * active_proc)
+{
+	struct socket * sender = sock->endpoint;
+	if(sock->messages->elements >= sock->queue_depth)
+		return;
+
+	// If the message cannot be queued, the sender is released with the error:
+	int retval = queue_message(sock, sender->blocking_details.iov, sender->blocking_details.count,
+		sender->blocking_details.length, sender->blocking_sender->parent, active_proc);
+	if(retval != 0)
+	{
+		release_thread(&sender->blocking_sender, retval);
+		return;
+	}
+
+	scheduler_wake_thread(sender->blocking_sender, SCHEDULER_BOOST_IPC);
+	context_set_syscall_retval(sender->blocking_sender->context, (void *) sender->blocking_details.length);
+	sender->blocking_sender = 0;
+}
@@ -10,6 +10,8 @@
 #include "queue.h"
 #include "thread.h"
 
+#include "api/socket.h"
+
 /**
  * @defgroup socket IPC Socket Support
  * @{
@@ -19,8 +21,14 @@
 #error "IPC socket buffer size is not set, define CONFIG_IPC_MSG_BUFLEN with the proper value"
 #endif
 
+struct waitset_entry;
+
 /**
  * IPC socket structure.
+ * Messages sent to a socket are normally passed directly from the sending
+ * thread to the receiving thread. If the socket has a message queue, messages
+ * are copied into the queue when no thread is receiving, so that the sending
+ * thread only blocks when the queue is full.
  */
 struct socket
 {
@@ -31,10 +39,18 @@ struct socket
 	struct thread * blocking_sender;
 	struct thread * blocking_waiter;
 
+	// Wait set registration, see waitset.h:
+	struct waitset_entry * waitset;
+
 	struct {
-		void * buffer;
+		struct mordax_iovec iov[MORDAX_SOCKET_MAX_IOV];
+		unsigned int count;
 		size_t length;
 	} blocking_details;
+
+	// Queue of messages sent to this socket:
+	struct queue * messages;
+	unsigned int queue_depth;
 };
 
 /**
@@ -56,6 +72,18 @@ void socket_destroy(struct socket * sock);
  */
 bool socket_connect(struct socket * a, struct socket * b);
 
+/**
+ * Sets the depth of the message queue of a socket. Messages already in the
+ * queue are kept if the depth is reduced.
+ * @param sock the socket.
+ * @param depth the maximum number of messages in the queue of the socket, 0
+ *              disables queueing.
+ * @param active_proc the process whose address space is active, used when
+ *                    a blocking sender's message is moved into the queue.
+ * @return 0 if successful or a negative error code on failure.
+ */
+int socket_set_queue_depth(struct socket * sock, unsigned int depth, struct process * active_proc);
+
 /**
  * Waits for a message to arrive and returns the size of it.
  * This does not remove the message from the message queue and socket_receive
@@ -70,32 +98,37 @@ int socket_wait(struct socket * sock, struct thread * waiting_thread,
 	bool * block);
 
 /**
- * Receives a message from a socket's endpoint. If the specified length does
- * not encompass the entire message, the next call to this function will
- * retrieve the next part of the message.
+ * Receives a message from a socket's endpoint. The message is copied
+ * directly into the segments of the receive buffer, and is truncated if it
+ * is longer than the receive buffer.
  * @param sock the socket to receive from.
  * @param receiving_thread the thread doing the receiving.
- * @param buffer a buffer to store the received message into.
- * @param length length of the receive buffer.
+ * @param iov the segments of the buffer to store the received message into.
+ *            The array is copied if the receiving thread blocks.
+ * @param count number of segments, at most `MORDAX_SOCKET_MAX_IOV`.
+ * @param flags socket flags, `MORDAX_SOCKET_NONBLOCK` to fail instead of blocking.
  * @param block a pointer to a variable that is set to `true` if the sending
  *              thread should be moved to the blocking queue.
  * @return length of the received message or < 0 on error.
  */
 int socket_receive(struct socket * sock, struct thread * receiving_thread,
-	void * buffer, size_t length, bool * block);
+	const struct mordax_iovec * iov, unsigned int count, unsigned int flags, bool * block);
 
 /**
  * Sends a message to a socket's endpoint.
  * @param sock the socket to send on.
  * @param sending_thread thread that is doing the sending.
- * @param buffer a buffer containing the message to send.
- * @param length length of the send buffer.
+ * @param iov the segments of the message to send. The array is copied if
+ *            the sending thread blocks.
+ * @param count number of segments, at most `MORDAX_SOCKET_MAX_IOV`.
+ * @param flags socket flags, `MORDAX_SOCKET_NONBLOCK` to fail instead of blocking.
  * @param block a pointer to a variable that is set to `true` if the sending
  *              thread should be moved to the blocking queue.
- * @return number of bytes sent.
+ * @return number of bytes sent or < 0 on error, `-ENOMEM` if the message could
+ *         not be queued.
  */
 int socket_send(struct socket * sock, struct thread * sending_thread,
-	const void * buffer, size_t length, bool * block);
+	const struct mordax_iovec * iov, unsigned int count, unsigned int flags, bool * block);
 
 /** @} */
 
@@ -3,6 +3,7 @@
 // Report bugs and issues on <http://github.com/skordal/mordax/issues>
 
 #include "context.h"
+#include "cycles.h"
 #include "debug.h"
 #include "dt.h"
 #include "irq.h"
@@ -10,122 +11,231 @@
 #include "lock.h"
 #include "mm.h"
 #include "process.h"
+#include "profile.h"
 #include "scheduler.h"
 #include "service.h"
+#include "smp.h"
 #include "syscall.h"
 #include "thread.h"
+#include "trace.h"
 #include "utils.h"
+#include "waitset.h"
 
+#include "api/batch.h"
 #include "api/dt.h"
 #include "api/errno.h"
+#include "api/pmu.h"
+#include "api/syscall_statistics.h"
 #include "api/syscalls.h"
 #include "api/system.h"
 #include "api/thread.h"
 
-// System call handler, called by target assembly code:
-void syscall_interrupt_handler(struct thread_context * context, uint8_t syscall)
+// System call handler function type:
+typedef void (*syscall_handler_func)(struct thread_context * context);
+
+// Table of system call handlers, indexed by system call number:
+static const syscall_handler_func syscall_table[] =
 {
-	switch(syscall)
-	{
-		case MORDAX_SYSCALL_SYSTEM:
-			syscall_system(context);
-			break;
+	[MORDAX_SYSCALL_SYSTEM] = syscall_system,
 
-		case MORDAX_SYSCALL_THREAD_EXIT:
-			syscall_thread_exit(context);
-			break;
-		case MORDAX_SYSCALL_THREAD_CREATE:
-			syscall_thread_create(context);
-			break;
-		case MORDAX_SYSCALL_THREAD_JOIN:
-			syscall_thread_join(context);
-			break;
-		case MORDAX_SYSCALL_THREAD_YIELD:
-			scheduler_reschedule();
-			break;
-		case MORDAX_SYSCALL_THREAD_INFO:
-			syscall_thread_info(context);
-			break;
+	[MORDAX_SYSCALL_THREAD_EXIT] = syscall_thread_exit,
+	[MORDAX_SYSCALL_THREAD_CREATE] = syscall_thread_create,
+	[MORDAX_SYSCALL_THREAD_JOIN] = syscall_thread_join,
+	[MORDAX_SYSCALL_THREAD_YIELD] = syscall_thread_yield,
+	[MORDAX_SYSCALL_THREAD_INFO] = syscall_thread_info,
 
-		case MORDAX_SYSCALL_PROCESS_CREATE:
-			syscall_process_create(context);
-			break;
+	[MORDAX_SYSCALL_PROCESS_CREATE] = syscall_process_create,
 
-		case MORDAX_SYSCALL_MAP:
-			syscall_memory_map(context);
-			break;
-		case MORDAX_SYSCALL_MAP_ALLOC:
-			syscall_memory_map_alloc(context);
-			break;
-		case MORDAX_SYSCALL_UNMAP:
-			syscall_memory_unmap(context);
-			break;
+	[MORDAX_SYSCALL_MAP] = syscall_memory_map,
+	[MORDAX_SYSCALL_MAP_ALLOC] = syscall_memory_map_alloc,
+	[MORDAX_SYSCALL_UNMAP] = syscall_memory_unmap,
 
-		case MORDAX_SYSCALL_SERVICE_CREATE:
-			syscall_service_create(context);
-			break;
-		case MORDAX_SYSCALL_SERVICE_LISTEN:
-			syscall_service_listen(context);
-			break;
-		case MORDAX_SYSCALL_SERVICE_CONNECT:
-			syscall_service_connect(context);
-			break;
+	[MORDAX_SYSCALL_SERVICE_CREATE] = syscall_service_create,
+	[MORDAX_SYSCALL_SERVICE_LISTEN] = syscall_service_listen,
+	[MORDAX_SYSCALL_SERVICE_CONNECT] = syscall_service_connect,
 
-		case MORDAX_SYSCALL_SOCKET_SEND:
-			syscall_socket_send(context);
-			break;
-		case MORDAX_SYSCALL_SOCKET_RECEIVE:
-			syscall_socket_receive(context);
-			break;
-		case MORDAX_SYSCALL_SOCKET_WAIT:
-			syscall_socket_wait(context);
-			break;
+	[MORDAX_SYSCALL_SOCKET_SEND] = syscall_socket_send,
+	[MORDAX_SYSCALL_SOCKET_RECEIVE] = syscall_socket_receive,
+	[MORDAX_SYSCALL_SOCKET_WAIT] = syscall_socket_wait,
 
-		case MORDAX_SYSCALL_LOCK_CREATE:
-			syscall_lock_create(context);
-			break;
-		case MORDAX_SYSCALL_LOCK_AQUIRE:
-			syscall_lock_aquire(context);
-			break;
-		case MORDAX_SYSCALL_LOCK_RELEASE:
-			syscall_lock_release(context);
-			break;
+	[MORDAX_SYSCALL_LOCK_CREATE] = syscall_lock_create,
+	[MORDAX_SYSCALL_LOCK_AQUIRE] = syscall_lock_aquire,
+	[MORDAX_SYSCALL_LOCK_RELEASE] = syscall_lock_release,
 
-		case MORDAX_SYSCALL_DT_GET_NODE_BY_PATH:
-			syscall_dt_get_node_by_path(context);
-			break;
-		case MORDAX_SYSCALL_DT_GET_NODE_BY_PHANDLE:
-			syscall_dt_get_node_by_phandle(context);
-			break;
-		case MORDAX_SYSCALL_DT_GET_NODE_BY_COMPATIBLE:
-			syscall_dt_get_node_by_compatible(context);
-			break;
-		case MORDAX_SYSCALL_DT_GET_PROPERTY_ARRAY32:
-			syscall_dt_get_property_array32(context);
-			break;
-		case MORDAX_SYSCALL_DT_GET_PROPERTY_STRING:
-			syscall_dt_get_property_string(context);
-			break;
-		case MORDAX_SYSCALL_DT_GET_PROPERTY_PHANDLE:
-			syscall_dt_get_property_phandle(context);
-			break;
+	[MORDAX_SYSCALL_DT_GET_NODE_BY_PATH] = syscall_dt_get_node_by_path,
+	[MORDAX_SYSCALL_DT_GET_NODE_BY_PHANDLE] = syscall_dt_get_node_by_phandle,
+	[MORDAX_SYSCALL_DT_GET_NODE_BY_COMPATIBLE] = syscall_dt_get_node_by_compatible,
+	[MORDAX_SYSCALL_DT_GET_PROPERTY_ARRAY32] = syscall_dt_get_property_array32,
+	[MORDAX_SYSCALL_DT_GET_PROPERTY_STRING] = syscall_dt_get_property_string,
+	[MORDAX_SYSCALL_DT_GET_PROPERTY_PHANDLE] = syscall_dt_get_property_phandle,
 
-		case MORDAX_SYSCALL_IRQ_CREATE:
-			syscall_irq_create(context);
-			break;
-		case MORDAX_SYSCALL_IRQ_LISTEN:
-			syscall_irq_listen(context);
-			break;
+	[MORDAX_SYSCALL_IRQ_CREATE] = syscall_irq_create,
+	[MORDAX_SYSCALL_IRQ_LISTEN] = syscall_irq_listen,
 
-		case MORDAX_SYSCALL_RESOURCE_DESTROY:
-			syscall_resource_destroy(context);
-			break;
+	[MORDAX_SYSCALL_RESOURCE_DESTROY] = syscall_resource_destroy,
+
+	[MORDAX_SYSCALL_BATCH] = syscall_batch,
+
+	[MORDAX_SYSCALL_THREAD_STATISTICS] = syscall_thread_statistics,
+	[MORDAX_SYSCALL_THREAD_SET_REALTIME] = syscall_thread_set_realtime,
+
+	[MORDAX_SYSCALL_WAITSET_CREATE] = syscall_waitset_create,
+	[MORDAX_SYSCALL_WAITSET_ADD] = syscall_waitset_add,
+	[MORDAX_SYSCALL_WAITSET_REMOVE] = syscall_waitset_remove,
+	[MORDAX_SYSCALL_WAITSET_WAIT] = syscall_waitset_wait,
+
+	[MORDAX_SYSCALL_SOCKET_SET_QUEUE_DEPTH] = syscall_socket_set_queue_depth,
+
+	[MORDAX_SYSCALL_SOCKET_SENDV] = syscall_socket_sendv,
+	[MORDAX_SYSCALL_SOCKET_RECEIVEV] = syscall_socket_receivev,
+
+	[MORDAX_SYSCALL_SERVICE_ACCEPT] = syscall_service_accept,
+	[MORDAX_SYSCALL_SERVICE_SET_BACKLOG] = syscall_service_set_backlog,
+
+	[MORDAX_SYSCALL_LOG_READ] = syscall_log_read,
+	[MORDAX_SYSCALL_TRACE_MAP] = syscall_trace_map,
+
+	[MORDAX_SYSCALL_THREAD_PMU] = syscall_thread_pmu,
+
+	[MORDAX_SYSCALL_PROFILE_START] = syscall_profile_start,
+	[MORDAX_SYSCALL_PROFILE_READ] = syscall_profile_read,
+
+	[MORDAX_SYSCALL_LOCK_STATISTICS] = syscall_lock_statistics,
+
+	[MORDAX_SYSCALL_THREAD_SLEEP] = syscall_thread_sleep,
+};
+
+// Table of system calls that can be part of a batch. These system calls
+// neither block nor reschedule, and only use their arguments and return
+// value from the thread context:
+static const bool syscall_batchable[] =
+{
+	[MORDAX_SYSCALL_SYSTEM] = true,
+	[MORDAX_SYSCALL_THREAD_INFO] = true,
+
+	[MORDAX_SYSCALL_MAP] = true,
+	[MORDAX_SYSCALL_MAP_ALLOC] = true,
+	[MORDAX_SYSCALL_UNMAP] = true,
+
+	[MORDAX_SYSCALL_SERVICE_CREATE] = true,
+
+	[MORDAX_SYSCALL_LOCK_CREATE] = true,
+	[MORDAX_SYSCALL_LOCK_RELEASE] = true,
+
+	[MORDAX_SYSCALL_DT_GET_NODE_BY_PATH] = true,
+	[MORDAX_SYSCALL_DT_GET_NODE_BY_PHANDLE] = true,
+	[MORDAX_SYSCALL_DT_GET_NODE_BY_COMPATIBLE] = true,
+	[MORDAX_SYSCALL_DT_GET_PROPERTY_ARRAY32] = true,
+	[MORDAX_SYSCALL_DT_GET_PROPERTY_STRING] = true,
+	[MORDAX_SYSCALL_DT_GET_PROPERTY_PHANDLE] = true,
+
+	[MORDAX_SYSCALL_IRQ_CREATE] = true,
+
+	[MORDAX_SYSCALL_RESOURCE_DESTROY] = true,
+
+	[MORDAX_SYSCALL_THREAD_STATISTICS] = true,
+
+	[MORDAX_SYSCALL_WAITSET_CREATE] = true,
+	[MORDAX_SYSCALL_WAITSET_ADD] = true,
+	[MORDAX_SYSCALL_WAITSET_REMOVE] = true,
+
+	[MORDAX_SYSCALL_SOCKET_SET_QUEUE_DEPTH] = true,
+
+	[MORDAX_SYSCALL_SERVICE_SET_BACKLOG] = true,
+
+	[MORDAX_SYSCALL_LOG_READ] = true,
+	[MORDAX_SYSCALL_TRACE_MAP] = true,
+
+	[MORDAX_SYSCALL_THREAD_PMU] = true,
+
+	[MORDAX_SYSCALL_PROFILE_START] = true,
+	[MORDAX_SYSCALL_PROFILE_READ] = true,
+
+	[MORDAX_SYSCALL_LOCK_STATISTICS] = true,
+};
+
+// Number of entries in the system call table:
+#define SYSCALL_TABLE_LENGTH	(sizeof(syscall_table) / sizeof(syscall_handler_func))
+
+#ifdef CONFIG_SYSCALL_STATISTICS
+// System call statistics for all processes, indexed by system call number:
+static struct mordax_syscall_statistics syscall_statistics[SYSCALL_TABLE_LENGTH];
+#endif
+
+// Gets information about the active thread:
+static uint32_t thread_info(int function);
+// Gets the process the active process may read statistics for, or 0 if it may
+// read the statistics of every process:
+static struct process * statistics_owner_filter(void);
+// Records a call to a system call in the system call statistics:
+static void record_syscall(struct process * caller, unsigned int syscall, uint32_t cycles);
+#ifdef CONFIG_SYSCALL_STATISTICS
+// Records a call with the specified latency in a system call statistics entry:
+static void record_latency(struct mordax_syscall_statistics * entry, uint32_t cycles);
+#endif
+// Copies the system call statistics of a process, or of all processes, to userspace:
+static int get_syscall_statistics(pid_t pid, struct mordax_syscall_statistics * buffer, unsigned int length);
+
+// Copies a list of segments from the calling process into kernel memory:
+static int copy_iov_from_user(struct mordax_iovec * dest, const struct mordax_iovec * iov, unsigned int count);
+// Sends a message consisting of the specified segments on a socket:
+static void socket_send_iov(struct thread_context * context, mordax_resource_t identifier,
+	const struct mordax_iovec * iov, unsigned int count, unsigned int flags);
+// Receives a message into the specified segments from a socket:
+static void socket_receive_iov(struct thread_context * context, mordax_resource_t identifier,
+	const struct mordax_iovec * iov, unsigned int count, unsigned int flags);
 
-		default: // TODO: handle unrecognized system calls
-			debug_printf("Unknown system call %d\n", syscall);
+// System call handler, called by target assembly code:
+void syscall_interrupt_handler(struct thread_context * context, unsigned syscall)
+{
+	uint32_t start = cycles_read();
+	spinlock_lock(&kernel_lock);
+	struct thread * caller = active_thread;
+	struct process * caller_process = caller->parent;
+	trace_event(MORDAX_TRACE_SYSCALL_ENTRY, syscall, 0);
+
+	if(syscall < SYSCALL_TABLE_LENGTH && syscall_table[syscall] != 0)
+		syscall_table[syscall](context);
+	else {
+		log_warning("Unknown system call %d\n", syscall);
+		// The register dump is part of the warning, so it is only printed
+		// if warnings are enabled:
+		if(MORDAX_LOG_WARNING <= CONFIG_LOG_LEVEL)
 			context_print(context);
-			break;
+		context_set_syscall_retval(context, (void *) -ENOSYS);
 	}
+
+	// A system call that blocked the caller ends with the switch to
+	// another thread instead:
+	if(active_thread == caller)
+		trace_event(MORDAX_TRACE_SYSCALL_EXIT, syscall, (uint32_t) context_get_syscall_retval(context));
+
+	// Switch to a boosted thread woken up by the system call, such as the
+	// receiver of an IPC message, right away:
+	if(scheduler_preemption_pending())
+		scheduler_reschedule();
+
+	// The thread exit system call may have freed the calling process:
+	record_syscall(syscall != MORDAX_SYSCALL_THREAD_EXIT ? caller_process : 0, syscall,
+		cycles_read() - start);
+	spinlock_unlock(&kernel_lock);
+}
+
+// Fast path for the thread information system call, called by target assembly
+// code without storing the context of the calling thread. Apart from that,
+// it is handled like any other system call:
+uint32_t syscall_thread_info_fast(int function)
+{
+	uint32_t start = cycles_read();
+	spinlock_lock(&kernel_lock);
+	trace_event(MORDAX_TRACE_SYSCALL_ENTRY, MORDAX_SYSCALL_THREAD_INFO, 0);
+
+	uint32_t retval = thread_info(function);
+
+	trace_event(MORDAX_TRACE_SYSCALL_EXIT, MORDAX_SYSCALL_THREAD_INFO, retval);
+	record_syscall(active_process, MORDAX_SYSCALL_THREAD_INFO, cycles_read() - start);
+	spinlock_unlock(&kernel_lock);
+	return retval;
 }
 
 void syscall_system(struct thread_context * context)
@@ -144,8 +254,17 @@ void syscall_system(struct thread_context * context)
 		case MORDAX_SYSTEM_GETSPLIT:
 			context_set_syscall_retval(context, (void *) CONFIG_KERNEL_SPLIT);
 			break;
+		case MORDAX_SYSTEM_SYSCALL_STATISTICS:
+		{
+			pid_t pid = (pid_t) context_get_syscall_argument(context, 1);
+			struct mordax_syscall_statistics * buffer = context_get_syscall_argument(context, 2);
+			unsigned int length = (unsigned int) context_get_syscall_argument(context, 3);
+
+			context_set_syscall_retval(context, (void *) get_syscall_statistics(pid, buffer, length));
+			break;
+		}
 		default:
-			debug_printf("Unknown function for the system syscall: %d\n", function);
+			log_warning("Unknown function for the system syscall: %d\n", function);
 			break;
 	}
 }
@@ -171,7 +290,7 @@ void syscall_thread_create(struct thread_context * context)
 
 void syscall_thread_join(struct thread_context * context)
 {
-	debug_printf("PID %d, TID %d wants to join with TID %d\n", active_thread->parent->pid,
+	log_debug("PID %d, TID %d wants to join with TID %d\n", active_thread->parent->pid,
 		active_thread->tid, (tid_t) context_get_syscall_argument(context, 0));
 
 	struct thread * join_thread = process_get_thread_by_tid(active_thread->parent,
@@ -187,28 +306,123 @@ void syscall_thread_join(struct thread_context * context)
 	}
 }
 
+void syscall_thread_yield(struct thread_context * context)
+{
+	scheduler_reschedule();
+}
+
+void syscall_thread_sleep(struct thread_context * context)
+{
+	uint32_t microseconds = (uint32_t) context_get_syscall_argument(context, 0);
+
+	context_set_syscall_retval(context, 0);
+	scheduler_sleep_thread(active_thread, microseconds);
+	scheduler_reschedule();
+}
+
 void syscall_thread_info(struct thread_context * context)
 {
 	int function = (int) context_get_syscall_argument(context, 0);
+	context_set_syscall_retval(context, (void *) thread_info(function));
+}
 
+static uint32_t thread_info(int function)
+{
 	switch(function)
 	{
 		case MORDAX_THREAD_INFO_GET_TID:
-			context_set_syscall_retval(context, (void *) active_thread->tid);
-			break;
+			return active_thread->tid;
 		case MORDAX_THREAD_INFO_GET_PID:
-			context_set_syscall_retval(context, (void *) active_thread->parent->pid);
-			break;
+			return active_thread->parent->pid;
 		case MORDAX_THREAD_INFO_GET_UID:
-			context_set_syscall_retval(context, (void *) active_thread->parent->owner_user);
-			break;
+			return active_thread->parent->owner_user;
 		case MORDAX_THREAD_INFO_GET_GID:
-			context_set_syscall_retval(context, (void *) active_thread->parent->owner_group);
-			break;
+			return active_thread->parent->owner_group;
+		case MORDAX_THREAD_INFO_GET_INFO_PAGE:
+			return (uint32_t) PROCESS_INFO_PAGE_ADDRESS(active_thread->parent);
 		default:
-			context_set_syscall_retval(context, (void *) -1);
-			break;
+			return -1;
+	}
+}
+
+static struct process * statistics_owner_filter(void)
+{
+	if((active_process->permissions & MORDAX_PROCESS_PERMISSION_STATISTICS) != 0)
+		return 0;
+	else
+		return active_process;
+}
+
+static void record_syscall(struct process * caller, unsigned int syscall, uint32_t cycles)
+{
+#ifdef CONFIG_SYSCALL_STATISTICS
+	if(syscall >= SYSCALL_TABLE_LENGTH)
+		return;
+
+	record_latency(&syscall_statistics[syscall], cycles);
+	if(caller == 0)
+		return;
+
+	if(caller->syscall_statistics == 0)
+	{
+		caller->syscall_statistics = mm_allocate(sizeof(syscall_statistics), MM_DEFAULT_ALIGNMENT,
+			MM_MEM_NORMAL);
+		if(caller->syscall_statistics == 0)
+			return;
+		memclr(caller->syscall_statistics, sizeof(syscall_statistics));
+	}
+	record_latency(&caller->syscall_statistics[syscall], cycles);
+#endif
+}
+
+#ifdef CONFIG_SYSCALL_STATISTICS
+static void record_latency(struct mordax_syscall_statistics * entry, uint32_t cycles)
+{
+	unsigned int bucket = cycles == 0 ? 0 : min(log2(cycles), MORDAX_SYSCALL_HISTOGRAM_BUCKETS - 1);
+
+	++entry->count;
+	entry->cycles += cycles;
+	++entry->histogram[bucket];
+}
+#endif
+
+static int get_syscall_statistics(pid_t pid, struct mordax_syscall_statistics * buffer, unsigned int length)
+{
+#ifdef CONFIG_SYSCALL_STATISTICS
+	if(length > 0 && (length > UINT32_MAX / sizeof(struct mordax_syscall_statistics)
+		|| !mmu_access_permitted(0, buffer, length * sizeof(struct mordax_syscall_statistics),
+			MMU_ACCESS_WRITE|MMU_ACCESS_USER)))
+	{
+		log_error("Error: cannot get system call statistics, cannot access buffer\n");
+		return -EFAULT;
+	}
+
+	struct process * owner = statistics_owner_filter();
+	if(owner != 0 && pid != owner->pid)
+	{
+		log_error("Error: cannot get system call statistics, calling process lacks permission to do so\n");
+		return -EPERM;
+	}
+
+	const struct mordax_syscall_statistics * source = syscall_statistics;
+	if(pid != MORDAX_SYSCALL_STATISTICS_ALL)
+	{
+		struct process * p = scheduler_get_process(pid);
+		if(p == 0)
+			return -ESRCH;
+		source = p->syscall_statistics;
 	}
+
+	length = min(length, SYSCALL_TABLE_LENGTH);
+	if(source != 0)
+		memcpy(buffer, source, length * sizeof(struct mordax_syscall_statistics));
+	else
+		memclr(buffer, length * sizeof(struct mordax_syscall_statistics));
+
+	return SYSCALL_TABLE_LENGTH;
+#else
+	return -ENOSYS;
+#endif
 }
 
 void syscall_process_create(struct thread_context * context)
@@ -222,7 +436,7 @@ void syscall_process_create(struct thread_context * context)
 	// Check for permission to create a new process:
 	if((active_thread->parent->permissions & MORDAX_PROCESS_PERMISSION_CREATE_PROC) == 0)
 	{
-		debug_printf("Error: cannot create process, calling process lacks permission to do so\n");
+		log_error("Error: cannot create process, calling process lacks permission to do so\n");
 		context_set_syscall_retval(context, (void *) -EPERM);
 		return;
 	}
@@ -230,7 +444,7 @@ void syscall_process_create(struct thread_context * context)
 	if(!mmu_access_permitted(0, procinfo_ptr, sizeof(struct mordax_process_info), MMU_ACCESS_READ|MMU_ACCESS_USER))
 	{
 		// TODO: terminate calling process.
-		debug_printf("Error: cannot create process: cannot access process info structure\n");
+		log_error("Error: cannot create process: cannot access process info structure\n");
 		retval = (void *) -EFAULT;
 		goto _error_return;
 	} else {
@@ -243,7 +457,7 @@ void syscall_process_create(struct thread_context * context)
 	proc = process_create(&procinfo_cpy);
 	if(proc == 0)
 	{
-		debug_printf("Error: could not create process: process_create failed\n");
+		log_error("Error: could not create process: process_create failed\n");
 		retval = (void *) -ENOEXEC;
 		goto _error_return;
 	}
@@ -252,7 +466,7 @@ void syscall_process_create(struct thread_context * context)
 	init_thread = process_add_new_thread(proc, procinfo_cpy.entry_point, (void *) PROCESS_DEFAULT_STACK_TOP);
 	if(init_thread == 0)
 	{
-		debug_printf("Error: could not create process: could not create thread\n");
+		log_error("Error: could not create process: could not create thread\n");
 		retval = (void *) -ENOEXEC;
 		goto _error_return;
 	}
@@ -275,7 +489,7 @@ void syscall_memory_map(struct thread_context * context)
 	// Check for required permissions:
 	if((active_process->permissions & MORDAX_PROCESS_PERMISSION_MAP_MEMORY) == 0)
 	{
-		debug_printf("Error: cannot map memory, calling process lacks permissions to do so\n");
+		log_error("Error: cannot map memory, calling process lacks permissions to do so\n");
 		context_set_syscall_retval(context, (void *) -EPERM);
 		return;
 	}
@@ -287,7 +501,7 @@ void syscall_memory_map(struct thread_context * context)
 
 	if(!mmu_access_permitted(0, attributes, sizeof(struct mordax_memory_attributes), MMU_ACCESS_READ|MMU_ACCESS_USER))
 	{
-		debug_printf("Error: cannot map memory, cannot access attributes structure\n");
+		log_error("Error: cannot map memory, cannot access attributes structure\n");
 		context_set_syscall_retval(context, (void *) -EFAULT);
 		return;
 	}
@@ -300,13 +514,13 @@ void syscall_memory_map(struct thread_context * context)
 	// Check the addresses:
 	if((uint32_t) start_virtual >= CONFIG_KERNEL_SPLIT)
 	{
-		debug_printf("Error: target address cannot be in kernel space\n");
+		log_error("Error: target address cannot be in kernel space\n");
 		context_set_syscall_retval(context, (void *) -EFAULT);
 		return;
 	}
 	if(mm_is_physical_managed(start_physical))
 	{
-		debug_printf("Error: cannot map memory managed by the physical memory manager\n");
+		log_error("Error: cannot map memory managed by the physical memory manager\n");
 		context_set_syscall_retval(context, (void *) -EFAULT);
 		return;
 	}
@@ -327,39 +541,73 @@ void syscall_memory_map_alloc(struct thread_context * context)
 
 	if(!mmu_access_permitted(0, size, sizeof(size_t), MMU_ACCESS_READ|MMU_ACCESS_WRITE|MMU_ACCESS_USER))
 	{
-		debug_printf("Error: cannot map memory, cannot access memory area size\n");
+		log_error("Error: cannot map memory, cannot access memory area size\n");
 		context_set_syscall_retval(context, (void *) -EFAULT);
 		return;
 	}
 
 	if(!mmu_access_permitted(0, attributes, sizeof(struct mordax_memory_attributes), MMU_ACCESS_READ|MMU_ACCESS_USER))
 	{
-		debug_printf("Error: cannot map memory, cannot access memory attributes\n");
+		log_error("Error: cannot map memory, cannot access memory attributes\n");
 		context_set_syscall_retval(context, (void *) -EFAULT);
 		return;
 	}
 
-	if(*size > MM_MAXIMUM_PHYSICAL_BLOCK_SIZE)
+	size_t total_size = (*size + CONFIG_PAGE_SIZE - 1) & -CONFIG_PAGE_SIZE;
+	if(total_size < *size || (uint32_t) target + total_size < (uint32_t) target
+		|| (uint32_t) target + total_size > CONFIG_KERNEL_SPLIT)
 	{
-		debug_printf("Error: cannot map memory, memory request too large\n");
-		context_set_syscall_retval(context, (void *) -ENOMEM);
+		log_error("Error: cannot map memory, target address is in kernel space\n");
+		context_set_syscall_retval(context, (void *) -EFAULT);
 		return;
 	}
 
-	if((uint32_t) target > CONFIG_KERNEL_SPLIT)
+	// Mapping over existing memory would replace the mappings and leak the pages behind them:
+	if(mmu_is_mapped(active_thread->parent->translation_table, target, total_size))
 	{
-		debug_printf("Error: cannot map memory, target address is in kernel space\n");
-		context_set_syscall_retval(context, (void *) -EFAULT);
+		log_error("Error: cannot map memory, target area is already mapped\n");
+		*size = 0;
+		context_set_syscall_retval(context, (void *) -EEXIST);
 		return;
 	}
 
-	struct mm_physical_memory allocation;
-	mm_allocate_physical(*size, &allocation);
-	*size = allocation.size;
+	// Allocate the memory as a sequence of physical blocks, using the
+	// largest block size that fits the remaining size, so that no more
+	// memory than requested is allocated:
+	size_t mapped = 0;
+	while(mapped < total_size)
+	{
+		size_t block_size = total_size - mapped;
+		if(block_size > MM_MAXIMUM_PHYSICAL_BLOCK_SIZE)
+			block_size = MM_MAXIMUM_PHYSICAL_BLOCK_SIZE;
+		else
+			block_size = 1 << log2(block_size);
+
+		struct mm_physical_memory allocation;
+		if(!mm_allocate_physical(block_size, &allocation))
+		{
+			log_error("Error: cannot map memory, out of physical memory\n");
+
+			// Unmapping the blocks allocated so far also frees them:
+			if(mapped > 0)
+			{
+				mmu_unmap(active_thread->parent->translation_table, target, mapped);
+				mmu_invalidate();
+			}
+
+			*size = 0;
+			context_set_syscall_retval(context, (void *) -ENOMEM);
+			return;
+		}
+
+		mmu_map(active_thread->parent->translation_table, allocation.base,
+			(void *) ((uint32_t) target + mapped), allocation.size, attributes->type,
+			attributes->permissions);
+		mapped += allocation.size;
+	}
 
-	void * retval = mmu_map(active_thread->parent->translation_table, allocation.base, target,
-		allocation.size, attributes->type, attributes->permissions);
-	context_set_syscall_retval(context, retval);
+	*size = mapped;
+	context_set_syscall_retval(context, target);
 	mmu_invalidate();
 }
 
@@ -371,7 +619,14 @@ void syscall_memory_unmap(struct thread_context * context)
 	// TODO: do better checking of what the memory area to unmap contains.
 	if((uint32_t) start_unmap >= CONFIG_KERNEL_SPLIT)
 	{
-		debug_printf("Error: cannot unmap memory in the kernel's address space\n");
+		log_error("Error: cannot unmap memory in the kernel's address space\n");
+		return;
+	}
+
+	uint32_t info_page = (uint32_t) PROCESS_INFO_PAGE_ADDRESS(active_process);
+	if((uint32_t) start_unmap <= info_page && info_page - (uint32_t) start_unmap < size)
+	{
+		log_error("Error: cannot unmap the information page\n");
 		return;
 	}
 
@@ -386,14 +641,14 @@ void syscall_service_create(struct thread_context * context)
 
 	if((active_process->permissions & MORDAX_PROCESS_PERMISSION_SERVICE) == 0)
 	{
-		debug_printf("Error: cannot create service, not permitted\n");
+		log_error("Error: cannot create service, not permitted\n");
 		context_set_syscall_retval(context, (void *) -EPERM);
 		return;
 	}
 
 	if(!mmu_access_permitted(0, (void *) name, name_length, MMU_ACCESS_READ|MMU_ACCESS_USER))
 	{
-		debug_printf("Error: cannot access service name, memory access denied\n");
+		log_error("Error: cannot access service name, memory access denied\n");
 		context_set_syscall_retval(context, (void *) -EFAULT);
 		return;
 	}
@@ -416,12 +671,12 @@ void syscall_service_create(struct thread_context * context)
 void syscall_service_listen(struct thread_context * context)
 {
 	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
-	debug_printf("PID %d, TID %d wants to listen to service %d\n",
+	log_debug("PID %d, TID %d wants to listen to service %d\n",
 		active_process->pid, active_thread->tid, identifier);
 
 	if((active_process->permissions & MORDAX_PROCESS_PERMISSION_SERVICE) == 0)
 	{
-		debug_printf("Error: cannot listen on service, operation not permitted\n");
+		log_error("Error: cannot listen on service, operation not permitted\n");
 		context_set_syscall_retval(context, (void *) -EPERM);
 		return;
 	}
@@ -430,34 +685,89 @@ void syscall_service_listen(struct thread_context * context)
 	struct service * svc = process_get_resource(active_process, identifier, &restype);
 	if(svc == 0)
 	{
-		debug_printf("Error: no resource associated with identifier %d\n",
+		log_error("Error: no resource associated with identifier %d\n",
 			identifier);
 		context_set_syscall_retval(context, (void *) -EINVAL);
 		return;
 	} else if(restype != PROCESS_RESOURCE_SERVICE)
 	{
-		debug_printf("Error: resource associated with identifier %d is not a service\n",
+		log_error("Error: resource associated with identifier %d is not a service\n",
 			identifier);
 		context_set_syscall_retval(context, (void *) -EINVAL);
 		return;
 	}
 
 	bool blocking = false;
-	struct socket * server_socket = 0;
-	int retval = service_listen(svc, active_thread, &server_socket, &blocking);
+	int retval = service_listen(svc, active_thread, &blocking);
 
 	if(blocking)
 	{
 		scheduler_move_thread_to_blocking(active_thread);
 		scheduler_reschedule();
-	} else if(retval < 0)
-	{
+	} else
 		context_set_syscall_retval(context, (void *) retval);
-	} else {
-		retval = process_add_resource(active_process, PROCESS_RESOURCE_SOCKET,
-			server_socket);
+}
+
+void syscall_service_accept(struct thread_context * context)
+{
+	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
+	mordax_resource_t * sockets = context_get_syscall_argument(context, 1);
+	unsigned int length = (unsigned int) context_get_syscall_argument(context, 2);
+
+	log_debug("PID %d, TID %d wants to accept up to %d connections on service %d\n",
+		active_process->pid, active_thread->tid, length, identifier);
+
+	if((active_process->permissions & MORDAX_PROCESS_PERMISSION_SERVICE) == 0)
+	{
+		log_error("Error: cannot accept connections, operation not permitted\n");
+		context_set_syscall_retval(context, (void *) -EPERM);
+		return;
+	}
+
+	enum process_resource_type restype;
+	struct service * svc = process_get_resource(active_process, identifier, &restype);
+	if(svc == 0 || restype != PROCESS_RESOURCE_SERVICE)
+	{
+		log_error("Error: resource associated with identifier %d is not a service\n",
+			identifier);
+		context_set_syscall_retval(context, (void *) -EINVAL);
+		return;
+	}
+
+	if(length > UINT32_MAX / sizeof(mordax_resource_t)
+		|| !mmu_access_permitted(0, sockets, length * sizeof(mordax_resource_t),
+			MMU_ACCESS_READ|MMU_ACCESS_WRITE|MMU_ACCESS_USER))
+	{
+		log_error("Error: cannot accept connections, cannot access socket array\n");
+		context_set_syscall_retval(context, (void *) -EFAULT);
+		return;
+	}
+
+	bool blocking = false;
+	int retval = service_accept(svc, active_thread, sockets, length, &blocking);
+
+	if(blocking)
+	{
+		scheduler_move_thread_to_blocking(active_thread);
+		scheduler_reschedule();
+	} else
 		context_set_syscall_retval(context, (void *) retval);
+}
+
+void syscall_service_set_backlog(struct thread_context * context)
+{
+	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
+	unsigned int limit = (unsigned int) context_get_syscall_argument(context, 1);
+
+	enum process_resource_type restype;
+	struct service * svc = process_get_resource(active_process, identifier, &restype);
+	if(svc == 0 || restype != PROCESS_RESOURCE_SERVICE)
+	{
+		context_set_syscall_retval(context, (void *) -EINVAL);
+		return;
 	}
+
+	context_set_syscall_retval(context, (void *) service_set_backlog(svc, limit));
 }
 
 void syscall_service_connect(struct thread_context * context)
@@ -467,23 +777,23 @@ void syscall_service_connect(struct thread_context * context)
 
 	if(!mmu_access_permitted(0, (void *) name, name_length, MMU_ACCESS_READ|MMU_ACCESS_USER))
 	{
-		debug_printf("Error: cannot access service name, memory access not permitted\n");
+		log_error("Error: cannot access service name, memory access not permitted\n");
 		context_set_syscall_retval(context, (void *) -EFAULT);
 		return;
 	}
 
 	char * service_name = mm_allocate(name_length + 1, MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
 	memclr(service_name, name_length + 1);
-	memcpy(service_name, name, name_length + 1);
+	memcpy(service_name, name, name_length);
 
 	struct service * svc = service_lookup(service_name);
 	if(svc == 0)
 	{
-		debug_printf("Error: the service \"%s\" does not exist\n");
+		log_error("Error: the service \"%s\" does not exist\n", service_name);
 		context_set_syscall_retval(context, (void *) -ENOENT);
 		goto _cleanup;
 	} else
-		debug_printf("Connecting to service \"%s\"\n", service_name);
+		log_debug("Connecting to service \"%s\"\n", service_name);
 
 	struct socket * client_socket = 0;
 	bool block = false;
@@ -509,113 +819,82 @@ _cleanup:
 void syscall_socket_send(struct thread_context * context)
 {
 	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
-	const void * buffer = context_get_syscall_argument(context, 1);
-	size_t buffer_length = (size_t) context_get_syscall_argument(context, 2);
-
-	debug_printf("PID %d, TID %d wants to send %d bytes on socket %d\n", active_process->pid,
-		active_thread->tid, buffer_length, identifier);
-
-	if(!mmu_access_permitted(0, buffer, buffer_length, MMU_ACCESS_READ|MMU_ACCESS_USER))
-	{
-		debug_printf("Error: cannot send message, buffer pointer points to invalid memory\n");
-		context_set_syscall_retval(context, (void *) -EFAULT);
-		return;
-	}
-
-	enum process_resource_type restype;
-	struct socket * send_socket = process_get_resource(active_process, identifier, &restype);
-	if(restype != PROCESS_RESOURCE_SOCKET)
-	{
-		debug_printf("Error: cannot send message, resource is not a socket\n");
-		context_set_syscall_retval(context, (void *) -ENOTSOCK);
-		return;
-	}
-
-	if(send_socket->endpoint == 0)
-	{
-		debug_printf("Error: cannot send message, socket is not connected\n");
-		context_set_syscall_retval(context, (void *) -ENOTCONN);
-		return;
-	}
-
-	bool block = false;
-	int retval = socket_send(send_socket, active_thread, buffer, buffer_length, &block);
-
-	if(block)
-	{
-		scheduler_move_thread_to_blocking(active_thread);
-		scheduler_reschedule();
-	} else
-		context_set_syscall_retval(context, (void *) retval);
+	struct mordax_iovec iov = {
+		.base = context_get_syscall_argument(context, 1),
+		.length = (size_t) context_get_syscall_argument(context, 2)
+	};
+
+	log_debug("PID %d, TID %d wants to send %d bytes on socket %d\n", active_process->pid,
+		active_thread->tid, iov.length, identifier);
+	socket_send_iov(context, identifier, &iov, 1, 0);
 }
 
 void syscall_socket_receive(struct thread_context * context)
 {
 	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
-	void * buffer = context_get_syscall_argument(context, 1);
-	size_t buffer_length = (size_t) context_get_syscall_argument(context, 2);
+	struct mordax_iovec iov = {
+		.base = context_get_syscall_argument(context, 1),
+		.length = (size_t) context_get_syscall_argument(context, 2)
+	};
+
+	log_debug("PID %d, TID %d wants to receive %d bytes on socket %d\n", active_process->pid,
+		active_thread->tid, iov.length, identifier);
+	socket_receive_iov(context, identifier, &iov, 1, 0);
+}
 
-	debug_printf("PID %d, TID %d wants to receive %d bytes on socket %d\n", active_process->pid,
-		active_thread->tid, buffer_length, identifier);
+void syscall_socket_sendv(struct thread_context * context)
+{
+	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
+	const struct mordax_iovec * user_iov = context_get_syscall_argument(context, 1);
+	unsigned int count = (unsigned int) context_get_syscall_argument(context, 2);
+	unsigned int flags = (unsigned int) context_get_syscall_argument(context, 3);
 
-	if(!mmu_access_permitted(0, buffer, buffer_length, MMU_ACCESS_WRITE|MMU_ACCESS_USER))
-	{
-		debug_printf("Error: cannot receive message, buffer pointer points to invalid memory\n");
-		context_set_syscall_retval(context, (void *) -EFAULT);
-		return;
-	}
+	log_debug("PID %d, TID %d wants to send %d segments on socket %d\n", active_process->pid,
+		active_thread->tid, count, identifier);
 
-	enum process_resource_type restype;
-	struct socket * receive_socket = process_get_resource(active_process, identifier, &restype);
-	if(restype != PROCESS_RESOURCE_SOCKET)
-	{
-		debug_printf("Error: cannot receive message, resource is not a socket\n");
-		context_set_syscall_retval(context, (void *) -ENOTSOCK);
-		return;
-	}
+	struct mordax_iovec iov[MORDAX_SOCKET_MAX_IOV];
+	int retval = copy_iov_from_user(iov, user_iov, count);
+	if(retval < 0)
+		context_set_syscall_retval(context, (void *) retval);
+	else
+		socket_send_iov(context, identifier, iov, count, flags);
+}
 
-	if(receive_socket->endpoint == 0)
-	{
-		debug_printf("Error: cannot receive message, socket is not connected\n");
-		context_set_syscall_retval(context, (void *) -ENOTCONN);
-		return;
-	}
+void syscall_socket_receivev(struct thread_context * context)
+{
+	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
+	const struct mordax_iovec * user_iov = context_get_syscall_argument(context, 1);
+	unsigned int count = (unsigned int) context_get_syscall_argument(context, 2);
+	unsigned int flags = (unsigned int) context_get_syscall_argument(context, 3);
 
-	bool block = false;
-	int retval = socket_receive(receive_socket, active_thread, buffer, buffer_length, &block);
+	log_debug("PID %d, TID %d wants to receive into %d segments on socket %d\n", active_process->pid,
+		active_thread->tid, count, identifier);
 
-	if(block)
-	{
-		scheduler_move_thread_to_blocking(active_thread);
-		scheduler_reschedule();
-	} else
+	struct mordax_iovec iov[MORDAX_SOCKET_MAX_IOV];
+	int retval = copy_iov_from_user(iov, user_iov, count);
+	if(retval < 0)
 		context_set_syscall_retval(context, (void *) retval);
+	else
+		socket_receive_iov(context, identifier, iov, count, flags);
 }
 
 void syscall_socket_wait(struct thread_context * context)
 {
 	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
 
-	debug_printf("PID %d, TID %d waiting for a message on socket %d\n", active_process->pid,
+	log_debug("PID %d, TID %d waiting for a message on socket %d\n", active_process->pid,
 		active_thread->tid, identifier);
 
 	enum process_resource_type restype;
 	struct socket * wait_socket = process_get_resource(active_process, identifier, &restype);
 	if(restype != PROCESS_RESOURCE_SOCKET)
 	{
-		debug_printf("Error: cannot wait on resource %d, resource is not a socket\n",
+		log_error("Error: cannot wait on resource %d, resource is not a socket\n",
 			identifier);
 		context_set_syscall_retval(context, (void *) -ENOTSOCK);
 		return;
 	}
 
-	if(wait_socket->endpoint == 0)
-	{
-		debug_printf("Error: cannot wait on socket, socket is not connected\n");
-		context_set_syscall_retval(context, (void *) -ENOTCONN);
-		return;
-	}
-
 	bool block = false;
 	int retval = socket_wait(wait_socket, active_thread, &block);
 	if(block)
@@ -634,7 +913,7 @@ void syscall_lock_create(struct thread_context * context)
 		return;
 	}
 
-	struct lock * new_lock = lock_create();
+	struct lock * new_lock = lock_create(active_process->pid);
 	if(new_lock == 0)
 	{
 		context_set_syscall_retval(context, (void *) -ENOMEM);
@@ -928,7 +1207,7 @@ void syscall_irq_create(struct thread_context * context)
 void syscall_irq_listen(struct thread_context * context)
 {
 	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
-	debug_printf("PID %d, TID %d wants to listen on IRQ resource %d\n",
+	log_debug("PID %d, TID %d wants to listen on IRQ resource %d\n",
 		active_process->pid, active_thread->tid, identifier);
 
 	if((active_process->permissions & MORDAX_PROCESS_PERMISSION_IRQ) == 0)
@@ -959,7 +1238,7 @@ void syscall_irq_listen(struct thread_context * context)
 void syscall_resource_destroy(struct thread_context * context)
 {
 	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
-	debug_printf("PID %d, TID %d wants to destroy resource %d\n",
+	log_debug("PID %d, TID %d wants to destroy resource %d\n",
 		active_process->pid, active_thread->tid, identifier);
 
 	enum process_resource_type restype;
@@ -982,6 +1261,9 @@ void syscall_resource_destroy(struct thread_context * context)
 		case PROCESS_RESOURCE_IRQ:
 			irq_object_destroy(res);
 			break;
+		case PROCESS_RESOURCE_WAITSET:
+			waitset_destroy(res);
+			break;
 		default:
 			context_set_syscall_retval(context, (void *) -EINVAL);
 	}
@@ -989,3 +1271,419 @@ void syscall_resource_destroy(struct thread_context * context)
 	context_set_syscall_retval(context, (void *) 0);
 }
 
+void syscall_batch(struct thread_context * context)
+{
+	struct mordax_batch_entry * entries = context_get_syscall_argument(context, 0);
+	unsigned int count = (unsigned int) context_get_syscall_argument(context, 1);
+
+	for(unsigned int i = 0; i < count; ++i)
+	{
+		// The access check is repeated for every entry, as earlier entries
+		// may have changed the mappings of the calling process:
+		if(!mmu_access_permitted(0, &entries[i], sizeof(struct mordax_batch_entry),
+			MMU_ACCESS_READ|MMU_ACCESS_WRITE|MMU_ACCESS_USER))
+		{
+			log_error("Error: cannot execute batch, cannot access entry %d\n", i);
+			context_set_syscall_retval(context, (void *) -EFAULT);
+			return;
+		}
+
+		unsigned int syscall = entries[i].syscall;
+		if(syscall >= sizeof(syscall_batchable) / sizeof(bool) || !syscall_batchable[syscall])
+		{
+			entries[i].retval = (void *) -ENOSYS;
+			continue;
+		}
+
+		// Run the system call using the context of the calling thread:
+		for(unsigned int arg = 0; arg < 4; ++arg)
+			context_set_syscall_argument(context, arg, entries[i].arguments[arg]);
+		syscall_table[syscall](context);
+		entries[i].retval = context_get_syscall_retval(context);
+	}
+
+	context_set_syscall_retval(context, 0);
+}
+
+void syscall_thread_statistics(struct thread_context * context)
+{
+	struct mordax_thread_statistics * buffer = context_get_syscall_argument(context, 0);
+	unsigned int length = (unsigned int) context_get_syscall_argument(context, 1);
+
+	if(length > 0 && (length > UINT32_MAX / sizeof(struct mordax_thread_statistics)
+		|| !mmu_access_permitted(0, buffer, length * sizeof(struct mordax_thread_statistics),
+			MMU_ACCESS_READ|MMU_ACCESS_WRITE|MMU_ACCESS_USER)))
+	{
+		log_error("Error: cannot get thread statistics, cannot access buffer\n");
+		context_set_syscall_retval(context, (void *) -EFAULT);
+		return;
+	}
+
+	context_set_syscall_retval(context, (void *) scheduler_get_statistics(buffer, length,
+		statistics_owner_filter()));
+}
+
+void syscall_thread_set_realtime(struct thread_context * context)
+{
+	tid_t tid = (tid_t) context_get_syscall_argument(context, 0);
+	uint32_t budget = (uint32_t) context_get_syscall_argument(context, 1);
+	uint32_t period = (uint32_t) context_get_syscall_argument(context, 2);
+
+	if((active_process->permissions & MORDAX_PROCESS_PERMISSION_REALTIME) == 0)
+	{
+		log_error("Error: cannot set real-time parameters, calling process lacks permission to do so\n");
+		context_set_syscall_retval(context, (void *) -EPERM);
+		return;
+	}
+
+	struct thread * t = process_get_thread_by_tid(active_process, tid);
+	if(t == 0)
+	{
+		context_set_syscall_retval(context, (void *) -ESRCH);
+		return;
+	}
+
+	context_set_syscall_retval(context, (void *) scheduler_set_realtime(t, budget, period));
+}
+
+void syscall_waitset_create(struct thread_context * context)
+{
+	struct waitset * set = waitset_create();
+	if(set == 0)
+	{
+		context_set_syscall_retval(context, (void *) -ENOMEM);
+		return;
+	}
+
+	mordax_resource_t retval = process_add_resource(active_process, PROCESS_RESOURCE_WAITSET, set);
+	context_set_syscall_retval(context, (void *) retval);
+}
+
+void syscall_waitset_add(struct thread_context * context)
+{
+	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
+	mordax_resource_t resource = (mordax_resource_t) context_get_syscall_argument(context, 1);
+
+	enum process_resource_type restype;
+	struct waitset * set = process_get_resource(active_process, identifier, &restype);
+	if(set == 0 || restype != PROCESS_RESOURCE_WAITSET)
+	{
+		context_set_syscall_retval(context, (void *) -EINVAL);
+		return;
+	}
+
+	void * resource_ptr = process_get_resource(active_process, resource, &restype);
+	if(resource_ptr == 0)
+	{
+		context_set_syscall_retval(context, (void *) -EINVAL);
+		return;
+	}
+
+	if(restype == PROCESS_RESOURCE_IRQ && (active_process->permissions & MORDAX_PROCESS_PERMISSION_IRQ) == 0)
+	{
+		context_set_syscall_retval(context, (void *) -EPERM);
+		return;
+	}
+
+	context_set_syscall_retval(context, (void *) waitset_add(set, restype, resource_ptr, resource));
+}
+
+void syscall_waitset_remove(struct thread_context * context)
+{
+	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
+	mordax_resource_t resource = (mordax_resource_t) context_get_syscall_argument(context, 1);
+
+	enum process_resource_type restype;
+	struct waitset * set = process_get_resource(active_process, identifier, &restype);
+	if(set == 0 || restype != PROCESS_RESOURCE_WAITSET)
+	{
+		context_set_syscall_retval(context, (void *) -EINVAL);
+		return;
+	}
+
+	void * resource_ptr = process_get_resource(active_process, resource, &restype);
+	if(resource_ptr == 0)
+	{
+		context_set_syscall_retval(context, (void *) -EINVAL);
+		return;
+	}
+
+	context_set_syscall_retval(context, (void *) waitset_remove(set, restype, resource_ptr));
+}
+
+void syscall_waitset_wait(struct thread_context * context)
+{
+	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
+	struct mordax_waitset_event * buffer = context_get_syscall_argument(context, 1);
+	unsigned int length = (unsigned int) context_get_syscall_argument(context, 2);
+
+	enum process_resource_type restype;
+	struct waitset * set = process_get_resource(active_process, identifier, &restype);
+	if(set == 0 || restype != PROCESS_RESOURCE_WAITSET)
+	{
+		context_set_syscall_retval(context, (void *) -EINVAL);
+		return;
+	}
+
+	if(length > UINT32_MAX / sizeof(struct mordax_waitset_event)
+		|| !mmu_access_permitted(0, buffer, length * sizeof(struct mordax_waitset_event),
+			MMU_ACCESS_READ|MMU_ACCESS_WRITE|MMU_ACCESS_USER))
+	{
+		log_error("Error: cannot wait on wait set, cannot access event buffer\n");
+		context_set_syscall_retval(context, (void *) -EFAULT);
+		return;
+	}
+
+	bool block = false;
+	int retval = waitset_wait(set, active_thread, buffer, length, &block);
+	if(block)
+	{
+		scheduler_move_thread_to_blocking(active_thread);
+		scheduler_reschedule();
+	} else
+		context_set_syscall_retval(context, (void *) retval);
+}
+
+void syscall_socket_set_queue_depth(struct thread_context * context)
+{
+	mordax_resource_t identifier = (mordax_resource_t) context_get_syscall_argument(context, 0);
+	unsigned int depth = (unsigned int) context_get_syscall_argument(context, 1);
+
+	enum process_resource_type restype;
+	struct socket * sock = process_get_resource(active_process, identifier, &restype);
+	if(sock == 0 || restype != PROCESS_RESOURCE_SOCKET)
+	{
+		context_set_syscall_retval(context, (void *) -ENOTSOCK);
+		return;
+	}
+
+	context_set_syscall_retval(context, (void *) socket_set_queue_depth(sock, depth, active_process));
+}
+
+static int copy_iov_from_user(struct mordax_iovec * dest, const struct mordax_iovec * iov, unsigned int count)
+{
+	if(count > MORDAX_SOCKET_MAX_IOV)
+		return -EINVAL;
+
+	if(!mmu_access_permitted(0, iov, count * sizeof(struct mordax_iovec), MMU_ACCESS_READ|MMU_ACCESS_USER))
+	{
+		log_error("Error: cannot access segment list\n");
+		return -EFAULT;
+	}
+
+	memcpy(dest, iov, count * sizeof(struct mordax_iovec));
+	return 0;
+}
+
+static void socket_send_iov(struct thread_context * context, mordax_resource_t identifier,
+	const struct mordax_iovec * iov, unsigned int count, unsigned int flags)
+{
+	for(unsigned int i = 0; i < count; ++i)
+	{
+		if(!mmu_access_permitted(0, iov[i].base, iov[i].length, MMU_ACCESS_READ|MMU_ACCESS_USER))
+		{
+			log_error("Error: cannot send message, buffer pointer points to invalid memory\n");
+			context_set_syscall_retval(context, (void *) -EFAULT);
+			return;
+		}
+	}
+
+	enum process_resource_type restype;
+	struct socket * send_socket = process_get_resource(active_process, identifier, &restype);
+	if(send_socket == 0 || restype != PROCESS_RESOURCE_SOCKET)
+	{
+		log_error("Error: cannot send message, resource is not a socket\n");
+		context_set_syscall_retval(context, (void *) -ENOTSOCK);
+		return;
+	}
+
+	if(send_socket->endpoint == 0)
+	{
+		log_error("Error: cannot send message, socket is not connected\n");
+		context_set_syscall_retval(context, (void *) -ENOTCONN);
+		return;
+	}
+
+	bool block = false;
+	int retval = socket_send(send_socket, active_thread, iov, count, flags, &block);
+
+	if(block)
+	{
+		scheduler_move_thread_to_blocking(active_thread);
+		scheduler_reschedule();
+	} else
+		context_set_syscall_retval(context, (void *) retval);
+}
+
+static void socket_receive_iov(struct thread_context * context, mordax_resource_t identifier,
+	const struct mordax_iovec * iov, unsigned int count, unsigned int flags)
+{
+	for(unsigned int i = 0; i < count; ++i)
+	{
+		if(!mmu_access_permitted(0, iov[i].base, iov[i].length, MMU_ACCESS_WRITE|MMU_ACCESS_USER))
+		{
+			log_error("Error: cannot receive message, buffer pointer points to invalid memory\n");
+			context_set_syscall_retval(context, (void *) -EFAULT);
+			return;
+		}
+	}
+
+	enum process_resource_type restype;
+	struct socket * receive_socket = process_get_resource(active_process, identifier, &restype);
+	if(receive_socket == 0 || restype != PROCESS_RESOURCE_SOCKET)
+	{
+		log_error("Error: cannot receive message, resource is not a socket\n");
+		context_set_syscall_retval(context, (void *) -ENOTSOCK);
+		return;
+	}
+
+	bool block = false;
+	int retval = socket_receive(receive_socket, active_thread, iov, count, flags, &block);
+
+	if(block)
+	{
+		scheduler_move_thread_to_blocking(active_thread);
+		scheduler_reschedule();
+	} else
+		context_set_syscall_retval(context, (void *) retval);
+}
+
+void syscall_log_read(struct thread_context * context)
+{
+	uint32_t * position = context_get_syscall_argument(context, 0);
+	char * buffer = context_get_syscall_argument(context, 1);
+	size_t length = (size_t) context_get_syscall_argument(context, 2);
+
+	if((active_process->permissions & MORDAX_PROCESS_PERMISSION_LOG) == 0)
+	{
+		log_error("Error: cannot read the kernel log, calling process lacks permission to do so\n");
+		context_set_syscall_retval(context, (void *) -EPERM);
+		return;
+	}
+
+	if(!mmu_access_permitted(0, position, sizeof(uint32_t), MMU_ACCESS_READ|MMU_ACCESS_WRITE|MMU_ACCESS_USER)
+		|| (length > 0 && !mmu_access_permitted(0, buffer, length, MMU_ACCESS_WRITE|MMU_ACCESS_USER)))
+	{
+		log_error("Error: cannot read the kernel log, cannot access buffer\n");
+		context_set_syscall_retval(context, (void *) -EFAULT);
+		return;
+	}
+
+	context_set_syscall_retval(context, (void *) debug_log_read(position, buffer, length));
+}
+
+void syscall_trace_map(struct thread_context * context)
+{
+	if((active_process->permissions & MORDAX_PROCESS_PERMISSION_TRACE) == 0)
+	{
+		log_error("Error: cannot map trace buffer, calling process lacks permission to do so\n");
+		context_set_syscall_retval(context, (void *) -EPERM);
+		return;
+	}
+
+#ifdef CONFIG_TRACE_EVENTS
+	unsigned int cpu = (unsigned int) context_get_syscall_argument(context, 0);
+	void * target = context_get_syscall_argument(context, 1);
+
+	int retval = trace_map(active_process->translation_table, cpu, target);
+	if(retval < 0)
+		log_error("Error: cannot map trace buffer of processor %d at %p\n", cpu, target);
+	context_set_syscall_retval(context, (void *) retval);
+#else
+	context_set_syscall_retval(context, (void *) -ENOSYS);
+#endif
+}
+
+void syscall_thread_pmu(struct thread_context * context)
+{
+	const struct mordax_pmu_config * config = context_get_syscall_argument(context, 0);
+	struct mordax_pmu_counters * counters = context_get_syscall_argument(context, 1);
+
+	if((config != 0 && !mmu_access_permitted(0, config, sizeof(struct mordax_pmu_config), MMU_ACCESS_READ|MMU_ACCESS_USER))
+		|| (counters != 0 && !mmu_access_permitted(0, counters, sizeof(struct mordax_pmu_counters),
+			MMU_ACCESS_WRITE|MMU_ACCESS_USER)))
+	{
+		log_error("Error: cannot access performance counters, cannot access buffer\n");
+		context_set_syscall_retval(context, (void *) -EFAULT);
+		return;
+	}
+
+	int retval = 0;
+	if(config != 0)
+		retval = context_pmu_configure(context, config);
+	if(retval == 0 && counters != 0)
+		retval = context_pmu_read(context, counters);
+
+	if(retval == 0)
+		retval = context_pmu_get_num_counters();
+	context_set_syscall_retval(context, (void *) retval);
+}
+
+void syscall_profile_start(struct thread_context * context)
+{
+	if((active_process->permissions & MORDAX_PROCESS_PERMISSION_PROFILE) == 0)
+	{
+		log_error("Error: cannot start profiling, calling process lacks permission to do so\n");
+		context_set_syscall_retval(context, (void *) -EPERM);
+		return;
+	}
+
+#ifdef CONFIG_PROFILE_SAMPLES
+	uint32_t event = (uint32_t) context_get_syscall_argument(context, 0);
+	uint32_t period = (uint32_t) context_get_syscall_argument(context, 1);
+
+	context_set_syscall_retval(context, (void *) profile_start(event, period));
+#else
+	context_set_syscall_retval(context, (void *) -ENOSYS);
+#endif
+}
+
+void syscall_profile_read(struct thread_context * context)
+{
+	if((active_process->permissions & MORDAX_PROCESS_PERMISSION_PROFILE) == 0)
+	{
+		log_error("Error: cannot read profiler samples, calling process lacks permission to do so\n");
+		context_set_syscall_retval(context, (void *) -EPERM);
+		return;
+	}
+
+#ifdef CONFIG_PROFILE_SAMPLES
+	struct mordax_profile_sample * buffer = context_get_syscall_argument(context, 0);
+	size_t length = (size_t) context_get_syscall_argument(context, 1);
+	uint32_t * dropped = context_get_syscall_argument(context, 2);
+
+	if((length > 0 && (length > UINT32_MAX / sizeof(struct mordax_profile_sample)
+		|| !mmu_access_permitted(0, buffer, length * sizeof(struct mordax_profile_sample),
+			MMU_ACCESS_WRITE|MMU_ACCESS_USER)))
+		|| !mmu_access_permitted(0, dropped, sizeof(uint32_t), MMU_ACCESS_WRITE|MMU_ACCESS_USER))
+	{
+		log_error("Error: cannot read profiler samples, cannot access buffer\n");
+		context_set_syscall_retval(context, (void *) -EFAULT);
+		return;
+	}
+
+	context_set_syscall_retval(context, (void *) profile_read(buffer, length, dropped));
+#else
+	context_set_syscall_retval(context, (void *) -ENOSYS);
+#endif
+}
+
+void syscall_lock_statistics(struct thread_context * context)
+{
+	struct mordax_lock_statistics * buffer = context_get_syscall_argument(context, 0);
+	unsigned int length = (unsigned int) context_get_syscall_argument(context, 1);
+
+	if(length > 0 && (length > UINT32_MAX / sizeof(struct mordax_lock_statistics)
+		|| !mmu_access_permitted(0, buffer, length * sizeof(struct mordax_lock_statistics),
+			MMU_ACCESS_WRITE|MMU_ACCESS_USER)))
+	{
+		log_error("Error: cannot get lock statistics, cannot access buffer\n");
+		context_set_syscall_retval(context, (void *) -EFAULT);
+		return;
+	}
+
+	struct process * owner = statistics_owner_filter();
+	context_set_syscall_retval(context, (void *) lock_get_statistics(buffer, length,
+		owner == 0 ? -1 : owner->pid));
+}
+
@@ -42,6 +42,20 @@ void syscall_thread_create(struct thread_context * context);
  */
 void syscall_thread_join(struct thread_context * context);
 
+/**
+ * Thread yield syscall handler. Gives up the rest of the time slice of
+ * the calling thread.
+ * @param context process context information.
+ */
+void syscall_thread_yield(struct thread_context * context);
+
+/**
+ * Thread sleep syscall handler. Takes the number of microseconds to sleep
+ * as parameter and blocks the calling thread for at least that long.
+ * @param context process context information.
+ */
+void syscall_thread_sleep(struct thread_context * context);
+
 /**
  * Thread information syscall handler. Takes an integer parameter
  * specifying the information to return.
@@ -67,13 +81,15 @@ void syscall_memory_map(struct thread_context * context);
  * size of the requested memory and a pointer to the desired
  * attributes of the memory. A pointer to the mapped memory is
  * returned from the syscall, as well as the size argument being
- * updated with the actual size allocated and mapped.
+ * updated with the actual size allocated and mapped. Fails with
+ * `-EEXIST` if any part of the target area is already mapped.
  */
 void syscall_memory_map_alloc(struct thread_context * context);
 
 /**
  * Unmaps mapped virtual memory. Takes two arguments; the address
- * to start unmapping at and the size of the area to unmap.
+ * to start unmapping at and the size of the area to unmap. Areas
+ * containing the information page are not unmapped.
  */
 void syscall_memory_unmap(struct thread_context * context);
 
@@ -214,6 +230,153 @@ void syscall_irq_listen(struct thread_context * context);
  */
 void syscall_resource_destroy(struct thread_context * context);
 
+/**
+ * Batch syscall handler. Executes an array of system calls in one kernel
+ * entry, storing the return value of each system call in its array entry.
+ * @param context process context information.
+ */
+void syscall_batch(struct thread_context * context);
+
+/**
+ * Thread statistics syscall handler. Takes a pointer to an array of
+ * `mordax_thread_statistics` structures and the length of the array as
+ * parameters, and returns the number of threads found.
+ * @param context process context information.
+ */
+void syscall_thread_statistics(struct thread_context * context);
+
+/**
+ * Real-time parameter syscall handler. Takes the TID of a thread in the
+ * calling process, a budget and a period in microseconds as parameters, and
+ * makes the thread a real-time thread if it can be admitted. A budget of 0
+ * makes the thread a best-effort thread again.
+ * @param context process context information.
+ */
+void syscall_thread_set_realtime(struct thread_context * context);
+
+/**
+ * Wait set create syscall handler. Returns the identifier of a new,
+ * empty wait set.
+ * @param context process context information.
+ */
+void syscall_waitset_create(struct thread_context * context);
+
+/**
+ * Wait set add syscall handler. Takes the identifier of a wait set and the
+ * identifier of a socket, service, lock or IRQ resource as parameters, and
+ * adds the resource to the wait set.
+ * @param context process context information.
+ */
+void syscall_waitset_add(struct thread_context * context);
+
+/**
+ * Wait set remove syscall handler. Takes the identifier of a wait set and
+ * the identifier of a resource in the wait set as parameters, and removes the
+ * resource from the wait set.
+ * @param context process context information.
+ */
+void syscall_waitset_remove(struct thread_context * context);
+
+/**
+ * Wait set wait syscall handler. Takes the identifier of a wait set, a
+ * pointer to an array of `mordax_waitset_event` structures and the length of
+ * the array as parameters, and blocks until at least one resource in the wait
+ * set is ready. Returns the number of events stored in the array.
+ * @param context process context information.
+ */
+void syscall_waitset_wait(struct thread_context * context);
+
+/**
+ * Socket queue depth syscall handler. Takes the identifier of a socket and
+ * the maximum number of messages to queue on the socket as parameters.
+ * @param context process context information.
+ */
+void syscall_socket_set_queue_depth(struct thread_context * context);
+
+/**
+ * Vectored socket send syscall handler. Takes the identifier of a socket, a
+ * pointer to an array of `mordax_iovec` structures, the length of the array
+ * and socket flags as parameters, and sends the segments as one message.
+ * @param context process context information.
+ */
+void syscall_socket_sendv(struct thread_context * context);
+
+/**
+ * Vectored socket receive syscall handler. Takes the identifier of a socket,
+ * a pointer to an array of `mordax_iovec` structures, the length of the array
+ * and socket flags as parameters, and receives a message into the segments.
+ * @param context process context information.
+ */
+void syscall_socket_receivev(struct thread_context * context);
+
+/**
+ * Service accept syscall handler. Takes the identifier of a service, a
+ * pointer to an array of resource identifiers and the length of the array
+ * as parameters. Blocks until at least one client connects, and returns the
+ * number of server sockets stored in the array.
+ * @param context process context information.
+ */
+void syscall_service_accept(struct thread_context * context);
+
+/**
+ * Service backlog syscall handler. Takes the identifier of a service and the
+ * maximum number of clients waiting to connect to the service as parameters.
+ * @param context process context information.
+ */
+void syscall_service_set_backlog(struct thread_context * context);
+
+/**
+ * Kernel log syscall handler. Takes a pointer to a log position, a buffer and
+ * the length of the buffer as parameters, and copies messages from the kernel
+ * log into the buffer, returning the number of bytes copied.
+ * @param context process context information.
+ */
+void syscall_log_read(struct thread_context * context);
+
+/**
+ * Trace buffer syscall handler. Takes the index of a processor and a page
+ * aligned address as parameters, maps the trace buffer of the processor
+ * read-only at the address and returns the size of the mapping.
+ * @param context process context information.
+ */
+void syscall_trace_map(struct thread_context * context);
+
+/**
+ * Performance counter syscall handler. Takes a pointer to a counter
+ * configuration and a pointer to a buffer for the counter values as
+ * parameters. Either pointer may be 0. The counters of the calling thread
+ * are first configured and then read into the buffer, and the number of
+ * event counters available is returned.
+ * @param context process context information.
+ */
+void syscall_thread_pmu(struct thread_context * context);
+
+/**
+ * Profiler control syscall handler. Takes an event number and the number of
+ * events between each sample as parameters, and starts sampling, or stops
+ * sampling if the number of events is 0.
+ * @param context process context information.
+ */
+void syscall_profile_start(struct thread_context * context);
+
+/**
+ * Profiler sample syscall handler. Takes a pointer to an array of
+ * `mordax_profile_sample` structures, the length of the array and a pointer
+ * to a variable for the number of dropped samples as parameters, and removes
+ * samples from the sample buffer, returning the number of samples copied.
+ * @param context process context information.
+ */
+void syscall_profile_read(struct thread_context * context);
+
+/**
+ * Lock statistics syscall handler. Takes a pointer to an array of
+ * `mordax_lock_statistics` structures and the length of the array as
+ * parameters, and fills the array with the most contended locks, returning
+ * the number of entries filled in.
+ * @param context process context information.
+ */
+void syscall_lock_statistics(struct thread_context * context);
+
 /** @} */
 
 #endif
@@ -14,15 +14,24 @@ struct thread * thread_create(struct process * parent, void * entrypoint, void *
 		MM_MEM_NORMAL);
 	retval->parent = parent;
 	retval->tid = -1;
+	retval->cpu = 0;
+	retval->boost = 0;
+	retval->remaining_quantum = parent->quantum;
+	retval->budget = retval->period = retval->remaining_budget = 0;
+	retval->deadline = 0;
+	retval->timestamp = 0;
+	retval->runtime = retval->wait_time = 0;
+	retval->voluntary_switches = retval->involuntary_switches = 0;
+	retval->lock_wait_start = 0;
 	retval->context = context_new();
 	retval->exit_listeners = queue_new();
 
 	context_set_pc(retval->context, entrypoint);
 	context_set_sp(retval->context, stack);
 
-	debug_printf("Creating new thread for process %p:\n", parent);
-	debug_printf("\tEntry: %p\n", entrypoint);
-	debug_printf("\tStack: %p\n", stack);
+	log_debug("Creating new thread for process %p:\n", parent);
+	log_debug("\tEntry: %p\n", entrypoint);
+	log_debug("\tStack: %p\n", stack);
 
 	return retval;
 }
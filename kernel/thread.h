@@ -35,6 +35,25 @@ struct thread
 	struct process * parent;		//< Parent process of this thread.
 	struct queue * exit_listeners;		//< List of threads waiting for this thread to exit.
 	tid_t tid;				//< PID of this thread (more like thread ID).
+	unsigned int cpu;			//< Processor whose queues the thread is in.
+	unsigned int boost;			//< Wakeup priority boost, in time slices.
+	uint32_t remaining_quantum;		//< Time left of the current time slice, in microseconds.
+
+	// Real-time scheduling parameters, times are in microseconds:
+	uint32_t budget;			//< Processor time the thread may use in each period.
+	uint32_t period;			//< Real-time period, 0 for best-effort threads.
+	uint32_t remaining_budget;		//< Processor time left in the current period.
+	uint64_t deadline;			//< Absolute deadline of the current period.
+	uint64_t wakeup_time;			//< Time a sleeping thread is woken up.
+
+	// Scheduler statistics, times are in processor cycles:
+	uint64_t timestamp;			//< Time the thread started running or became ready.
+	uint64_t runtime;			//< Total time spent running.
+	uint64_t wait_time;			//< Total time spent waiting in a running queue.
+	uint32_t voluntary_switches;		//< Number of times the thread blocked or yielded.
+	uint32_t involuntary_switches;		//< Number of times the thread was preempted.
+
+	uint64_t lock_wait_start;		//< Time the thread started waiting for a lock, in microseconds.
 };
 
 /**
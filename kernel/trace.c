@@ -0,0 +1,92 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#include "mm.h"
+#include "mmu.h"
+#include "scheduler.h"
+#include "smp.h"
+#include "trace.h"
+#include "utils.h"
+
+#include "api/errno.h"
+
+#ifdef CONFIG_TRACE_EVENTS
+
+// Size of a trace buffer, rounded up to a whole number of pages so that the
+// buffer can be mapped into processes:
+#define TRACE_BUFFER_SIZE \
+	((sizeof(struct mordax_trace_buffer) + CONFIG_TRACE_EVENTS * sizeof(struct mordax_trace_event) \
+		+ CONFIG_PAGE_SIZE - 1) & -CONFIG_PAGE_SIZE)
+
+// Trace state for each processor:
+static struct
+{
+	struct mordax_trace_buffer * buffer;
+	unsigned int next;	// Index of the next event in the ring.
+} trace_cpus[CONFIG_MAX_CPUS];
+
+void trace_initialize(void)
+{
+	for(unsigned int cpu = 0; cpu < CONFIG_MAX_CPUS; ++cpu)
+	{
+		struct mordax_trace_buffer * buffer = mm_allocate(TRACE_BUFFER_SIZE, CONFIG_PAGE_SIZE,
+			MM_MEM_NORMAL);
+		memclr(buffer, TRACE_BUFFER_SIZE);
+		buffer->version = MORDAX_TRACE_VERSION;
+		buffer->cpu = cpu;
+		buffer->length = CONFIG_TRACE_EVENTS;
+
+		trace_cpus[cpu].buffer = buffer;
+		trace_cpus[cpu].next = 0;
+	}
+}
+
+void trace_event(unsigned int type, uint16_t data, uint32_t argument)
+{
+	unsigned int cpu = cpu_get_id();
+	struct mordax_trace_buffer * buffer = trace_cpus[cpu].buffer;
+	if(buffer == 0)
+		return;
+
+	struct mordax_trace_event * event = &buffer->events[trace_cpus[cpu].next];
+	event->timestamp = scheduler_get_cycles();
+	event->type = type;
+	event->data = data;
+	event->argument = argument;
+
+	if(++trace_cpus[cpu].next == CONFIG_TRACE_EVENTS)
+		trace_cpus[cpu].next = 0;
+
+	// Readers must not see the new head before the event is written:
+	__sync_synchronize();
+	++buffer->head;
+}
+
+void trace_clock(uint64_t cycles, uint64_t time)
+{
+	struct mordax_trace_buffer * buffer = trace_cpus[cpu_get_id()].buffer;
+	if(buffer == 0)
+		return;
+
+	buffer->clock_cycles = cycles;
+	buffer->clock_time = time;
+}
+
+int trace_map(struct mmu_translation_table * table, unsigned int cpu, void * target)
+{
+	if(cpu >= CONFIG_MAX_CPUS || trace_cpus[cpu].buffer == 0)
+		return -EINVAL;
+	if(target == 0 || ((uint32_t) target & (CONFIG_PAGE_SIZE - 1)) != 0
+		|| (uint32_t) target > CONFIG_KERNEL_SPLIT - TRACE_BUFFER_SIZE)
+		return -EINVAL;
+	if(mmu_is_mapped(table, target, TRACE_BUFFER_SIZE))
+		return -EEXIST;
+
+	mmu_map_shared(table, trace_cpus[cpu].buffer, target, TRACE_BUFFER_SIZE,
+		MORDAX_TYPE_RODATA, MORDAX_PERM_RW_RO);
+	return TRACE_BUFFER_SIZE;
+}
+
+#endif
+
@@ -0,0 +1,64 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_TRACE_H
+#define MORDAX_TRACE_H
+
+#include "mmu.h"
+
+#include "api/trace.h"
+#include "api/types.h"
+
+/**
+ * @ingroup trace
+ * Tracing is enabled by setting `CONFIG_TRACE_EVENTS` to the number of events
+ * in the trace buffer of each processor. If it is not set, the tracepoints
+ * are compiled to nothing.
+ * @{
+ */
+
+#ifdef CONFIG_TRACE_EVENTS
+
+/**
+ * Allocates the trace buffers.
+ */
+void trace_initialize(void);
+
+/**
+ * Records an event in the trace buffer of the current processor.
+ * @param type the type of the event.
+ * @param data small event argument.
+ * @param argument event argument.
+ */
+void trace_event(unsigned int type, uint16_t data, uint32_t argument);
+
+/**
+ * Updates the clock conversion fields of the trace buffer of the current processor.
+ * @param cycles the cycle count of the processor.
+ * @param time the scheduler clock, in microseconds, at the same time.
+ */
+void trace_clock(uint64_t cycles, uint64_t time);
+
+/**
+ * Maps the trace buffer of a processor read-only into a process.
+ * @param table translation table of the process.
+ * @param cpu index of the processor.
+ * @param target page aligned userspace address to map the buffer at.
+ * @return the size of the mapping or a negative error code, `-EEXIST` if
+ *         any page in the target range is already mapped.
+ */
+int trace_map(struct mmu_translation_table * table, unsigned int cpu, void * target);
+
+#else
+
+#define trace_initialize()			((void) 0)
+#define trace_event(type, data, argument)	((void) 0)
+#define trace_clock(cycles, time)		((void) 0)
+
+#endif
+
+/** @} */
+
+#endif
+
@@ -4,10 +4,28 @@
 
 #include "context.h"
 #include "kernel.h"
+#include "smp.h"
 #include "undef.h"
 
 void undef_interrupt_handler(struct thread_context * context)
 {
+	// Kernel code runs with the kernel lock held already:
+	if(context_get_mode(context) != CONTEXT_USERMODE)
+	{
+		context_print(context);
+		kernel_panic("unknown instruction attempted in kernel mode");
+	}
+
+	spinlock_lock(&kernel_lock);
+
+	// Threads using the floating point unit trap the first time they use it
+	// after a context switch:
+	if(context_fpu_trap(context))
+	{
+		spinlock_unlock(&kernel_lock);
+		return;
+	}
+
 	context_print(context);
 	kernel_panic("unknown instruction attempted");
 }
@@ -0,0 +1,288 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#include "context.h"
+#include "irq.h"
+#include "lock.h"
+#include "mm.h"
+#include "mmu.h"
+#include "scheduler.h"
+#include "service.h"
+#include "socket.h"
+#include "utils.h"
+#include "waitset.h"
+
+#include "api/errno.h"
+
+struct waitset
+{
+	// All registered resources:
+	struct waitset_entry * entries;
+
+	// Resources with pending events, in the order the events occured:
+	struct waitset_entry * ready_first, * ready_last;
+
+	// IRQ resources that have been reported and must be re-enabled when
+	// the wait set is waited on again:
+	struct waitset_entry * rearm;
+
+	struct thread * waiter;
+	struct {
+		struct mordax_waitset_event * buffer;
+		unsigned int length;
+	} wait_details;
+};
+
+// Gets the registration field of a resource and whether the resource is ready:
+static struct waitset_entry ** resource_watch(enum process_resource_type type, void * resource_ptr,
+	bool * ready);
+// Removes a registration from the ready list:
+static void remove_ready(struct waitset * set, struct waitset_entry * entry);
+// Removes a registration from the list of IRQs to re-enable:
+static void remove_rearm(struct waitset * set, struct waitset_entry * entry);
+// Removes a registration from a wait set and frees it:
+static void remove_entry(struct waitset * set, struct waitset_entry * entry);
+// Moves events from the ready list into the buffer of a thread:
+static unsigned int deliver(struct waitset * set, struct process * p,
+	struct mordax_waitset_event * buffer, unsigned int length);
+
+struct waitset * waitset_create(void)
+{
+	struct waitset * retval = mm_allocate(sizeof(struct waitset), MM_DEFAULT_ALIGNMENT,
+		MM_MEM_NORMAL);
+	memclr(retval, sizeof(struct waitset));
+	return retval;
+}
+
+void waitset_destroy(struct waitset * set)
+{
+	if(set->waiter != 0)
+	{
+		context_set_syscall_retval(set->waiter->context, (void *) -EIDRM);
+		scheduler_move_thread_to_running(set->waiter);
+	}
+
+	while(set->entries != 0)
+		remove_entry(set, set->entries);
+	mm_free(set);
+}
+
+int waitset_add(struct waitset * set, enum process_resource_type type, void * resource_ptr,
+	mordax_resource_t resource)
+{
+	bool ready = false;
+	struct waitset_entry ** watch = resource_watch(type, resource_ptr, &ready);
+	if(watch == 0)
+		return -EINVAL;
+	if(*watch != 0)
+		return -EBUSY;
+
+	struct waitset_entry * entry = mm_allocate(sizeof(struct waitset_entry),
+		MM_DEFAULT_ALIGNMENT, MM_MEM_NORMAL);
+	memclr(entry, sizeof(struct waitset_entry));
+
+	entry->set = set;
+	entry->watch = watch;
+	entry->type = type;
+	entry->resource_ptr = resource_ptr;
+	entry->resource = resource;
+
+	entry->next = set->entries;
+	if(set->entries != 0)
+		set->entries->prev = entry;
+	set->entries = entry;
+	*watch = entry;
+
+	if(type == PROCESS_RESOURCE_IRQ)
+		irq_enable(((struct irq_object *) resource_ptr)->irq);
+	if(ready)
+		waitset_notify(entry, MORDAX_WAITSET_READY);
+	return 0;
+}
+
+int waitset_remove(struct waitset * set, enum process_resource_type type, void * resource_ptr)
+{
+	bool ready;
+	struct waitset_entry ** watch = resource_watch(type, resource_ptr, &ready);
+	if(watch == 0)
+		return -EINVAL;
+	if(*watch == 0 || (*watch)->set != set)
+		return -ENOENT;
+
+	remove_entry(set, *watch);
+	return 0;
+}
+
+void waitset_unwatch(struct waitset_entry ** watch)
+{
+	if(*watch != 0)
+		remove_entry((*watch)->set, *watch);
+}
+
+void waitset_notify(struct waitset_entry * entry, unsigned int events)
+{
+	if(entry == 0)
+		return;
+
+	struct waitset * set = entry->set;
+
+	// Only the first event after the resource was last reported causes
+	// the registration to be added to the ready list:
+	if(entry->events == 0)
+	{
+		entry->next_ready = 0;
+		entry->prev_ready = set->ready_last;
+		if(set->ready_last != 0)
+			set->ready_last->next_ready = entry;
+		else
+			set->ready_first = entry;
+		set->ready_last = entry;
+	}
+	entry->events |= events;
+
+	if(set->waiter != 0)
+	{
+		unsigned int count = deliver(set, set->waiter->parent, set->wait_details.buffer,
+			set->wait_details.length);
+		context_set_syscall_retval(set->waiter->context, (void *) count);
+		scheduler_wake_thread(set->waiter, SCHEDULER_BOOST_IPC);
+		set->waiter = 0;
+	}
+}
+
+int waitset_wait(struct waitset * set, struct thread * waiting_thread,
+	struct mordax_waitset_event * buffer, unsigned int length, bool * block)
+{
+	*block = false;
+
+	if(set->waiter != 0)
+		return -EBUSY;
+	if(length == 0)
+		return -EINVAL;
+
+	// Re-enable the IRQs reported by the previous wait, the waiting
+	// thread has had the chance to handle them by now:
+	while(set->rearm != 0)
+	{
+		struct waitset_entry * entry = set->rearm;
+		set->rearm = entry->next_rearm;
+		entry->rearm = false;
+		irq_enable(((struct irq_object *) entry->resource_ptr)->irq);
+	}
+
+	if(set->ready_first != 0)
+		return deliver(set, waiting_thread->parent, buffer, length);
+
+	set->waiter = waiting_thread;
+	set->wait_details.buffer = buffer;
+	set->wait_details.length = length;
+	*block = true;
+	return 0;
+}
+
+static struct waitset_entry ** resource_watch(enum process_resource_type type, void * resource_ptr,
+	bool * ready)
+{
+	switch(type)
+	{
+		case PROCESS_RESOURCE_SOCKET:
+		{
+			struct socket * sock = resource_ptr;
+			*ready = sock->messages->elements > 0
+				|| (sock->endpoint != 0 && sock->endpoint->blocking_sender != 0);
+			return &sock->waitset;
+		}
+		case PROCESS_RESOURCE_SERVICE:
+		{
+			struct service * svc = resource_ptr;
+			*ready = svc->backlog->elements > 0;
+			return &svc->waitset;
+		}
+		case PROCESS_RESOURCE_LOCK:
+			*ready = lock_is_free(resource_ptr);
+			return lock_get_waitset(resource_ptr);
+		case PROCESS_RESOURCE_IRQ:
+			*ready = false;
+			return &((struct irq_object *) resource_ptr)->waitset;
+		default:
+			return 0;
+	}
+}
+
+static void remove_ready(struct waitset * set, struct waitset_entry * entry)
+{
+	if(entry->prev_ready != 0)
+		entry->prev_ready->next_ready = entry->next_ready;
+	else
+		set->ready_first = entry->next_ready;
+
+	if(entry->next_ready != 0)
+		entry->next_ready->prev_ready = entry->prev_ready;
+	else
+		set->ready_last = entry->prev_ready;
+
+	entry->events = 0;
+}
+
+static void remove_rearm(struct waitset * set, struct waitset_entry * entry)
+{
+	for(struct waitset_entry ** current = &set->rearm; *current != 0; current = &(*current)->next_rearm)
+	{
+		if(*current == entry)
+		{
+			*current = entry->next_rearm;
+			break;
+		}
+	}
+}
+
+static void remove_entry(struct waitset * set, struct waitset_entry * entry)
+{
+	if(entry->events != 0)
+		remove_ready(set, entry);
+	if(entry->rearm)
+		remove_rearm(set, entry);
+
+	if(entry->prev != 0)
+		entry->prev->next = entry->next;
+	else
+		set->entries = entry->next;
+	if(entry->next != 0)
+		entry->next->prev = entry->prev;
+
+	*entry->watch = 0;
+	mm_free(entry);
+}
+
+static unsigned int deliver(struct waitset * set, struct process * p,
+	struct mordax_waitset_event * buffer, unsigned int length)
+{
+	struct mmu_translation_table * current_tt = mmu_get_translation_table();
+	unsigned int count = 0;
+
+	// The buffer is in the address space of the waiting thread, which is not
+	// necessarily the active address space when a thread is woken up:
+	mmu_set_translation_table(p->translation_table);
+	while(count < length && set->ready_first != 0)
+	{
+		struct waitset_entry * entry = set->ready_first;
+		buffer[count].resource = entry->resource;
+		buffer[count].events = entry->events;
+		remove_ready(set, entry);
+
+		if(entry->type == PROCESS_RESOURCE_IRQ && !entry->rearm)
+		{
+			entry->next_rearm = set->rearm;
+			entry->rearm = true;
+			set->rearm = entry;
+		}
+
+		++count;
+	}
+
+	if(current_tt != 0)
+		mmu_set_translation_table(current_tt);
+	return count;
+}
+
@@ -0,0 +1,117 @@
+// The Mordax Microkernel
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef MORDAX_WAITSET_H
+#define MORDAX_WAITSET_H
+
+#include <stdbool.h>
+
+#include "process.h"
+#include "thread.h"
+
+#include "api/waitset.h"
+
+/**
+ * @defgroup waitset Wait Set Support
+ * Wait sets allow a thread to wait for several resources at the same time.
+ * Each resource that can be added to a wait set contains a pointer to its
+ * registration, which is used to put the registration on the ready list of
+ * the wait set when the resource becomes ready. Waiting on a wait set is
+ * therefore proportional to the number of ready resources and not to the
+ * number of registered resources.
+ * @{
+ */
+
+struct waitset;
+
+/**
+ * Registration of a resource in a wait set.
+ */
+struct waitset_entry
+{
+	struct waitset * set;
+	struct waitset_entry ** watch;		//< Field pointing to this entry in the resource.
+
+	enum process_resource_type type;
+	void * resource_ptr;
+	mordax_resource_t resource;		//< Identifier reported to the waiting thread.
+
+	unsigned int events;			//< Pending events, non-zero if on the ready list.
+	struct waitset_entry * prev, * next;	//< Links in the list of registered resources.
+	struct waitset_entry * prev_ready, * next_ready;
+	struct waitset_entry * next_rearm;	//< Link in the list of IRQs to re-enable.
+	bool rearm;				//< Whether the entry is on the list of IRQs to re-enable.
+};
+
+/**
+ * Creates a new wait set.
+ * @return the new wait set.
+ */
+struct waitset * waitset_create(void) __attribute((malloc));
+
+/**
+ * Destroys a wait set. All resources are removed from the wait set, and a
+ * thread waiting on the wait set is released with `-EIDRM`.
+ * @param set the wait set to destroy.
+ */
+void waitset_destroy(struct waitset * set);
+
+/**
+ * Adds a resource to a wait set. Sockets, services, locks and IRQ objects
+ * can be added to a wait set, and each resource can only be part of one wait
+ * set at a time. If the resource is already ready, it is reported by the next
+ * wait on the wait set.
+ * @param set the wait set.
+ * @param type the type of the resource.
+ * @param resource_ptr pointer to the resource.
+ * @param resource identifier of the resource, reported when the resource
+ *                 becomes ready.
+ * @return 0 if successful or a negative error code on failure.
+ */
+int waitset_add(struct waitset * set, enum process_resource_type type, void * resource_ptr,
+	mordax_resource_t resource);
+
+/**
+ * Removes a resource from a wait set.
+ * @param set the wait set.
+ * @param type the type of the resource.
+ * @param resource_ptr pointer to the resource.
+ * @return 0 if successful or a negative error code on failure.
+ */
+int waitset_remove(struct waitset * set, enum process_resource_type type, void * resource_ptr);
+
+/**
+ * Removes a resource from the wait set it is registered in, if any.
+ * This must be called when destroying resources that can be part of a
+ * wait set.
+ * @param watch pointer to the registration field of the resource.
+ */
+void waitset_unwatch(struct waitset_entry ** watch);
+
+/**
+ * Signals events on a resource. If the resource is registered in a wait set,
+ * the registration is put on the ready list of the wait set, and a thread
+ * waiting on the wait set is woken up.
+ * @param entry registration of the resource, may be 0.
+ * @param events the events that have occured.
+ */
+void waitset_notify(struct waitset_entry * entry, unsigned int events);
+
+/**
+ * Waits for resources in a wait set to become ready.
+ * @param set the wait set to wait on.
+ * @param waiting_thread the thread doing the waiting.
+ * @param buffer buffer to store the events into.
+ * @param length maximum number of events to store in the buffer.
+ * @param block a pointer to a variable that is set to `true` if the waiting
+ *              thread should be moved to the blocking queue.
+ * @return the number of events stored in the buffer or a negative error code.
+ */
+int waitset_wait(struct waitset * set, struct thread * waiting_thread,
+	struct mordax_waitset_event * buffer, unsigned int length, bool * block);
+
+/** @} */
+
+#endif
+
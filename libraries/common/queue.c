@@ -68,6 +68,28 @@ void queue_add_back(struct queue * q, void * e)
 	++q->elements;
 }
 
+void queue_insert_before(struct queue * q, struct queue_node * node, void * e)
+{
+	if(node == 0)
+	{
+		queue_add_back(q, e);
+		return;
+	}
+
+	struct queue_node * new_node = malloc(sizeof(struct queue_node));
+	new_node->data = e;
+	new_node->next = node;
+	new_node->prev = node->prev;
+
+	if(node->prev != 0)
+		node->prev->next = new_node;
+	else
+		q->first = new_node;
+
+	node->prev = new_node;
+	++q->elements;
+}
+
 bool queue_remove_front(struct queue * q, void ** e)
 {
 	if(q->first == 0)
@@ -124,6 +146,7 @@ void * queue_remove_node(struct queue * q, struct queue_node * node)
 		q->first = node->next;
 	if(q->last == node)
 		q->last = node->prev;
+	--q->elements;
 
 	free(node);
 	return retval;
@@ -55,6 +55,15 @@ void queue_add_front(struct queue * q, void * e);
  */
 void queue_add_back(struct queue * q, void * e);
 
+/**
+ * Inserts an element in front of a node in a queue.
+ * @param q the queue to add to.
+ * @param node the node to insert the element in front of. If this is `NULL`,
+ *             the element is added to the back of the queue.
+ * @param e the element to add to the queue.
+ */
+void queue_insert_before(struct queue * q, struct queue_node * node, void * e);
+
 /**
  * Removes an element to the front of a queue.
  * @param q the queue to remove from.
@@ -0,0 +1,409 @@
+// The Mordax Standard Library
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#include <coroutine.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#include <mordax.h>
+
+// Size of the stack of the I/O thread:
+#define IO_STACK_SIZE	4096
+
+// Size of a page, the unit of stack guard areas:
+#define PAGE_SIZE	4096
+
+// Number of registers saved by __coroutine_switch, see armv7/coroutine.S:
+#ifdef __ARM_FP
+#define SWITCH_FRAME_WORDS	(10 + 16)
+#else
+#define SWITCH_FRAME_WORDS	10
+#endif
+
+// Index of r4, r5 and lr in a switch frame:
+#define SWITCH_FRAME_R4	(SWITCH_FRAME_WORDS - 10)
+#define SWITCH_FRAME_R5	(SWITCH_FRAME_WORDS - 9)
+#define SWITCH_FRAME_LR	(SWITCH_FRAME_WORDS - 1)
+
+// Coroutine structure. This is placed at the top of the memory slot
+// of the coroutine, which allows the currently running coroutine to be
+// found from the stack pointer.
+struct coroutine
+{
+	struct coroutine_runtime * runtime;
+	void * stack_pointer;
+	struct coroutine * next;
+
+	// Blocking call to run on the I/O thread:
+	coroutine_blocking_func blocking_func;
+	void * blocking_argument, * blocking_retval;
+};
+
+struct coroutine_runtime
+{
+	// Run queue:
+	struct coroutine * ready_head, * ready_tail;
+	// Saved stack pointer of the thread running `coroutine_run`:
+	void * scheduler_stack_pointer;
+	// Coroutine that has exited and needs to be freed:
+	struct coroutine * exited;
+
+	// Total number of coroutines and number of coroutines waiting for
+	// blocking calls to finish:
+	unsigned int num_coroutines, num_blocked;
+
+	// I/O thread state, protected by `io_lock`:
+	mordax_resource_t io_lock;
+	struct coroutine * io_queue_head, * io_queue_tail;
+	struct coroutine * io_done;
+	bool io_running;
+
+	// I/O thread ID or -1 if there is no thread to join:
+	tid_t io_tid;
+	void * io_stack;
+};
+
+// Low level functions, defined in armv7/coroutine.S:
+extern void __coroutine_switch(void ** save_stack_pointer, void * new_stack_pointer);
+extern void __coroutine_entry(void);
+extern void __coroutine_io_entry(void);
+
+// Runs the requests queued for the I/O thread:
+void __coroutine_io_loop(struct coroutine_runtime * runtime);
+
+// Slot allocator. Slots are allocated downwards from the page below the
+// information page and are reused after they have been freed. The lock is
+// only held for a few instructions and is therefore a simple spinlock.
+static volatile int slot_lock = 0;
+static uint32_t slot_bottom = 0;
+static struct coroutine * free_slots = NULL;
+
+static struct coroutine * slot_allocate(void);
+static void slot_free(struct coroutine * coroutine);
+
+// Gets the currently running coroutine:
+static inline struct coroutine * current_coroutine(void)
+{
+	uint32_t sp;
+	asm volatile("mov %[sp], sp\n\t" : [sp] "=r" (sp));
+	return (struct coroutine *) (((sp | (COROUTINE_SLOT_SIZE - 1)) + 1) - sizeof(struct coroutine));
+}
+
+// Adds a coroutine to the end of the run queue:
+static inline void enqueue(struct coroutine_runtime * runtime, struct coroutine * coroutine)
+{
+	coroutine->next = NULL;
+	if(runtime->ready_tail == NULL)
+		runtime->ready_head = coroutine;
+	else
+		runtime->ready_tail->next = coroutine;
+	runtime->ready_tail = coroutine;
+}
+
+// Removes the coroutine at the front of the run queue:
+static inline struct coroutine * dequeue(struct coroutine_runtime * runtime)
+{
+	struct coroutine * retval = runtime->ready_head;
+	if(retval != NULL)
+	{
+		runtime->ready_head = retval->next;
+		if(runtime->ready_head == NULL)
+			runtime->ready_tail = NULL;
+	}
+	return retval;
+}
+
+// Switches from the calling coroutine to the next ready coroutine, or to the
+// scheduler if no coroutines are ready:
+static void suspend(struct coroutine_runtime * runtime, struct coroutine * current)
+{
+	struct coroutine * next = dequeue(runtime);
+	if(next != NULL)
+		__coroutine_switch(&current->stack_pointer, next->stack_pointer);
+	else
+		__coroutine_switch(&current->stack_pointer, runtime->scheduler_stack_pointer);
+}
+
+// Moves coroutines with finished blocking calls to the run queue:
+static void collect_completions(struct coroutine_runtime * runtime)
+{
+	mordax_lock_aquire(runtime->io_lock);
+	struct coroutine * done = runtime->io_done;
+	runtime->io_done = NULL;
+	mordax_lock_release(runtime->io_lock);
+
+	while(done != NULL)
+	{
+		struct coroutine * next = done->next;
+		enqueue(runtime, done);
+		--runtime->num_blocked;
+		done = next;
+	}
+}
+
+// Waits for the I/O thread to exit:
+static void join_io_thread(struct coroutine_runtime * runtime)
+{
+	if(runtime->io_tid != -1)
+	{
+		mordax_thread_join(runtime->io_tid);
+		runtime->io_tid = -1;
+	}
+}
+
+struct coroutine_runtime * coroutine_runtime_new(void)
+{
+	struct coroutine_runtime * retval = malloc(sizeof(struct coroutine_runtime));
+	if(retval == NULL)
+		return NULL;
+
+	retval->io_stack = malloc(IO_STACK_SIZE);
+	if(retval->io_stack == NULL)
+	{
+		free(retval);
+		return NULL;
+	}
+
+	retval->ready_head = retval->ready_tail = NULL;
+	retval->exited = NULL;
+	retval->num_coroutines = retval->num_blocked = 0;
+	retval->io_lock = mordax_lock_create();
+	retval->io_queue_head = retval->io_queue_tail = NULL;
+	retval->io_done = NULL;
+	retval->io_running = false;
+	retval->io_tid = -1;
+
+	return retval;
+}
+
+void coroutine_runtime_free(struct coroutine_runtime * runtime)
+{
+	join_io_thread(runtime);
+	mordax_resource_destroy(runtime->io_lock);
+	free(runtime->io_stack);
+	free(runtime);
+}
+
+struct coroutine_runtime * coroutine_runtime(void)
+{
+	return current_coroutine()->runtime;
+}
+
+int coroutine_create(struct coroutine_runtime * runtime, coroutine_func func, void * argument)
+{
+	struct coroutine * coroutine = slot_allocate();
+	if(coroutine == NULL)
+		return -ENOMEM;
+
+	// Set up a switch frame which makes __coroutine_switch return into the
+	// entry trampoline with the entry point in r4 and the argument in r5:
+	uint32_t * frame = (uint32_t *) coroutine - SWITCH_FRAME_WORDS;
+	frame[SWITCH_FRAME_R4] = (uint32_t) func;
+	frame[SWITCH_FRAME_R5] = (uint32_t) argument;
+	frame[SWITCH_FRAME_LR] = (uint32_t) __coroutine_entry;
+
+	coroutine->runtime = runtime;
+	coroutine->stack_pointer = frame;
+
+	++runtime->num_coroutines;
+	enqueue(runtime, coroutine);
+	return 0;
+}
+
+void coroutine_run(struct coroutine_runtime * runtime)
+{
+	while(runtime->num_coroutines > 0)
+	{
+		collect_completions(runtime);
+
+		struct coroutine * next = dequeue(runtime);
+		if(next == NULL)
+		{
+			// All coroutines are waiting for the I/O thread; it exits when
+			// it has no more requests, so wait for that to happen:
+			if(runtime->io_tid != -1)
+				join_io_thread(runtime);
+			else
+				mordax_thread_yield();
+			continue;
+		}
+
+		__coroutine_switch(&runtime->scheduler_stack_pointer, next->stack_pointer);
+
+		if(runtime->exited != NULL)
+		{
+			slot_free(runtime->exited);
+			runtime->exited = NULL;
+			--runtime->num_coroutines;
+		}
+	}
+
+	join_io_thread(runtime);
+}
+
+void coroutine_yield(void)
+{
+	struct coroutine * current = current_coroutine();
+	struct coroutine_runtime * runtime = current->runtime;
+
+	// Pick up finished blocking calls here as well, as the scheduler only
+	// does so when it runs, which a coroutine that keeps yielding would
+	// prevent. The list is checked without the lock first to avoid taking
+	// it on every yield:
+	if(runtime->num_blocked > 0 && ((volatile struct coroutine_runtime *) runtime)->io_done != NULL)
+		collect_completions(runtime);
+
+	// If no other coroutine is ready, let the I/O thread run instead:
+	if(runtime->ready_head == NULL)
+	{
+		if(runtime->num_blocked > 0)
+			mordax_thread_yield();
+		return;
+	}
+
+	enqueue(runtime, current);
+	suspend(runtime, current);
+}
+
+void coroutine_exit(void)
+{
+	struct coroutine * current = current_coroutine();
+	struct coroutine_runtime * runtime = current->runtime;
+
+	// The slot is freed by the scheduler, as the stack is in use until
+	// the switch is complete:
+	runtime->exited = current;
+	__coroutine_switch(&current->stack_pointer, runtime->scheduler_stack_pointer);
+	__builtin_unreachable();
+}
+
+void * coroutine_call_blocking(coroutine_blocking_func func, void * argument)
+{
+	struct coroutine * current = current_coroutine();
+	struct coroutine_runtime * runtime = current->runtime;
+	bool start_thread = false;
+
+	current->blocking_func = func;
+	current->blocking_argument = argument;
+	current->next = NULL;
+
+	mordax_lock_aquire(runtime->io_lock);
+	if(runtime->io_queue_tail == NULL)
+		runtime->io_queue_head = current;
+	else
+		runtime->io_queue_tail->next = current;
+	runtime->io_queue_tail = current;
+
+	if(!runtime->io_running)
+	{
+		runtime->io_running = true;
+		start_thread = true;
+	}
+	mordax_lock_release(runtime->io_lock);
+
+	if(start_thread)
+	{
+		// The previous I/O thread may still be exiting, and shares its
+		// stack with the new thread:
+		join_io_thread(runtime);
+
+		uint32_t * stack = (uint32_t *) (((uint32_t) runtime->io_stack + IO_STACK_SIZE) & -8) - 2;
+		stack[0] = (uint32_t) runtime;
+		runtime->io_tid = mordax_thread_create(__coroutine_io_entry, stack);
+
+		// If the I/O thread cannot be created, the request is the only one
+		// in the queue, as the other coroutines have not run since the
+		// queue was empty. Remove it and run the call on this thread:
+		if(runtime->io_tid < 0)
+		{
+			runtime->io_tid = -1;
+
+			mordax_lock_aquire(runtime->io_lock);
+			runtime->io_queue_head = runtime->io_queue_tail = NULL;
+			runtime->io_running = false;
+			mordax_lock_release(runtime->io_lock);
+
+			return func(argument);
+		}
+	}
+
+	++runtime->num_blocked;
+	suspend(runtime, current);
+
+	return current->blocking_retval;
+}
+
+void __coroutine_io_loop(struct coroutine_runtime * runtime)
+{
+	while(true)
+	{
+		mordax_lock_aquire(runtime->io_lock);
+		struct coroutine * request = runtime->io_queue_head;
+		if(request == NULL)
+		{
+			runtime->io_running = false;
+			mordax_lock_release(runtime->io_lock);
+			return;
+		}
+
+		runtime->io_queue_head = request->next;
+		if(runtime->io_queue_head == NULL)
+			runtime->io_queue_tail = NULL;
+		mordax_lock_release(runtime->io_lock);
+
+		request->blocking_retval = request->blocking_func(request->blocking_argument);
+
+		mordax_lock_aquire(runtime->io_lock);
+		request->next = runtime->io_done;
+		runtime->io_done = request;
+		mordax_lock_release(runtime->io_lock);
+	}
+}
+
+static struct coroutine * slot_allocate(void)
+{
+	struct coroutine * retval = NULL;
+
+	while(__sync_lock_test_and_set(&slot_lock, 1))
+		mordax_thread_yield();
+
+	if(free_slots != NULL)
+	{
+		retval = free_slots;
+		free_slots = retval->next;
+	} else {
+		if(slot_bottom == 0)
+			slot_bottom = (uint32_t) mordax_info_page() & -COROUTINE_SLOT_SIZE;
+
+		// Map everything except the lowest page of the slot, which is left
+		// unmapped to catch stack overflows:
+		struct mordax_memory_attributes attributes = {
+			.type = MORDAX_TYPE_DATA,
+			.permissions = MORDAX_PERM_RW_RW
+		};
+		void * base = (void *) (slot_bottom - COROUTINE_SLOT_SIZE + PAGE_SIZE);
+		size_t size = COROUTINE_SLOT_SIZE - PAGE_SIZE;
+
+		if(mordax_memory_map_alloc(base, &size, &attributes) == base)
+		{
+			retval = (struct coroutine *) (slot_bottom - sizeof(struct coroutine));
+			slot_bottom -= COROUTINE_SLOT_SIZE;
+		}
+	}
+
+	__sync_lock_release(&slot_lock);
+	return retval;
+}
+
+static void slot_free(struct coroutine * coroutine)
+{
+	while(__sync_lock_test_and_set(&slot_lock, 1))
+		mordax_thread_yield();
+
+	coroutine->next = free_slots;
+	free_slots = coroutine;
+
+	__sync_lock_release(&slot_lock);
+}
+
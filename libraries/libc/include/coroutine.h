@@ -0,0 +1,88 @@
+// The Mordax Standard Library
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+#ifndef __MORDAX_LIBC_COROUTINE_H__
+#define __MORDAX_LIBC_COROUTINE_H__
+
+#include <sys/types.h>
+
+/**
+ * Size of the memory area reserved for each coroutine. The lowest page of
+ * the area is left unmapped as a guard page, and the coroutine structure is
+ * stored at the top of the area, so the usable stack is a bit smaller than
+ * this. Must be a power of two.
+ */
+#define COROUTINE_SLOT_SIZE	16384
+
+/** Coroutine entry point function type. */
+typedef void (*coroutine_func)(void * argument);
+
+/** Function type for functions run on the I/O thread of a runtime. */
+typedef void * (*coroutine_blocking_func)(void * argument);
+
+/**
+ * Coroutine runtime. A runtime contains a cooperative run queue of
+ * coroutines which is run by a single thread using `coroutine_run`.
+ */
+struct coroutine_runtime;
+
+/**
+ * Creates a new coroutine runtime.
+ * @return a pointer to the new runtime or `NULL` if an error occurs.
+ */
+struct coroutine_runtime * coroutine_runtime_new(void);
+
+/**
+ * Frees a coroutine runtime. The runtime must not contain any coroutines.
+ * @param runtime the runtime to free.
+ */
+void coroutine_runtime_free(struct coroutine_runtime * runtime);
+
+/**
+ * Gets the runtime of the calling coroutine.
+ * @return the runtime running the calling coroutine.
+ */
+struct coroutine_runtime * coroutine_runtime(void);
+
+/**
+ * Creates a new coroutine and adds it to the run queue of a runtime.
+ * @param runtime the runtime to add the coroutine to.
+ * @param func entry point of the coroutine.
+ * @param argument argument passed to the entry point.
+ * @return 0 if successful, otherwise a negative error code.
+ */
+int coroutine_create(struct coroutine_runtime * runtime, coroutine_func func, void * argument);
+
+/**
+ * Runs the coroutines of a runtime on the calling thread until all of
+ * them have exited.
+ * @param runtime the runtime to run.
+ */
+void coroutine_run(struct coroutine_runtime * runtime);
+
+/**
+ * Gives up the processor to the next coroutine in the run queue.
+ */
+void coroutine_yield(void);
+
+/**
+ * Exits the calling coroutine. Returning from the entry point of a
+ * coroutine also exits it.
+ */
+void coroutine_exit(void) __attribute((noreturn));
+
+/**
+ * Runs a function that may block, such as an IPC system call, on the I/O
+ * thread of the runtime. The calling coroutine is suspended until the
+ * function returns, while the other coroutines keep running. If the I/O
+ * thread cannot be started, the function is run on the calling thread.
+ * @param func the function to run. It runs on another thread, and must not
+ *             use any coroutine functions.
+ * @param argument argument passed to the function.
+ * @return the return value of the function.
+ */
+void * coroutine_call_blocking(coroutine_blocking_func func, void * argument);
+
+#endif
+
@@ -57,17 +57,15 @@ void * sbrk(size_t incr)
 		.permissions = MORDAX_PERM_RW_RW
 	};
 
-	// Increase the dataspace in page-sized intervals:
+	// Increase the dataspace using a single allocation:
 	mordax_lock_aquire(lock);
-	for(int i = 0; i < incr / 4096; ++i)
+	size_t size = incr;
+	if(mordax_memory_map_alloc(program_break, &size, &attributes) != program_break)
 	{
-		const void * target = program_break;
-		const size_t size = 4096;
-		mordax_memory_map_alloc(program_break, &size, &attributes);
-
-		program_break = (void *) ((uint32_t) target + size);
-		free_memory += size;
+		mordax_lock_release(lock);
+		return NULL;
 	}
+	program_break = (void *) ((uint32_t) program_break + size);
 
 	struct memory_block * last_block = first_block;
 	while(last_block->next != NULL)
@@ -3,5 +3,6 @@
 # Report bugs and issues on <http://github.com/skordal/mordax/issues>
 
 ASSEMBLER_FILES += \
+	armv7/info.S \
 	armv7/syscalls.S
 
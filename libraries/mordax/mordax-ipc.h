@@ -5,6 +5,8 @@
 #ifndef __MORDAX_IPC_H__
 #define __MORDAX_IPC_H__
 
+#include <mordax/service.h>
+#include <mordax/socket.h>
 #include <mordax/types.h>
 
 /**
@@ -17,12 +19,37 @@
 mordax_resource_t mordax_service_create(const char * name, size_t name_len);
 
 /**
- * Listens on a service.
+ * Listens on a service. Any number of threads can listen on a service at
+ * the same time, and connecting clients are handed to the threads in the
+ * order they started listening.
  * @param service handle to the service to listen to.
  * @return handle to the socket of a connecting client.
  */
 mordax_resource_t mordax_service_listen(mordax_resource_t service);
 
+/**
+ * Accepts several connections to a service at once. All clients waiting to
+ * connect, up to the length of the array, are accepted. If no clients are
+ * waiting, the calling thread blocks until a client connects.
+ * @param service handle to the service to accept connections on.
+ * @param sockets array where the handles to the new sockets are stored.
+ * @param length length of the array.
+ * @return the number of accepted connections or a negative error number.
+ */
+int mordax_service_accept(mordax_resource_t service, mordax_resource_t * sockets,
+	unsigned int length);
+
+/**
+ * Sets the maximum number of clients that can wait to connect to a service.
+ * Connecting to a service with a full backlog fails with `-ECONNREFUSED`.
+ * @param service handle to the service.
+ * @param limit maximum number of waiting clients, at most
+ *              `MORDAX_SERVICE_MAX_BACKLOG`. The default is
+ *              `MORDAX_SERVICE_DEFAULT_BACKLOG`.
+ * @return 0 if successful or a negative error number.
+ */
+int mordax_service_set_backlog(mordax_resource_t service, unsigned int limit);
+
 /**
  * Connects to a service.
  * @param name name of the service to connect to.
@@ -33,7 +60,10 @@ mordax_resource_t mordax_service_listen(mordax_resource_t service);
 mordax_resource_t mordax_service_connect(const char * name, size_t name_len);
 
 /**
- * Sends a message on a socket.
+ * Sends a message on a socket. If no thread is receiving on the other end of
+ * the socket, the message is put in the message queue of the other end, and
+ * the calling thread only blocks if the queue is full. Use
+ * `mordax_socket_sendv` to send without blocking.
  * @param socket the socket to send on.
  * @param buffer buffer containing the message to send.
  * @param length length of the message.
@@ -42,7 +72,9 @@ mordax_resource_t mordax_service_connect(const char * name, size_t name_len);
 int mordax_socket_send(mordax_resource_t socket, const void * buffer, size_t length);
 
 /**
- * Receives a message from a socket.
+ * Receives a message from a socket. Queued messages can be received after
+ * the other end of the socket has been closed. Use `mordax_socket_receivev`
+ * to receive without blocking.
  * @param socket the socket to receive from.
  * @param buffer destination buffer.
  * @param length length of the destination buffer.
@@ -50,6 +82,46 @@ int mordax_socket_send(mordax_resource_t socket, const void * buffer, size_t len
  */
 int mordax_socket_receive(mordax_resource_t socket, void * buffer, size_t length);
 
+/**
+ * Sends a message consisting of several segments on a socket, without first
+ * copying the segments into one buffer. The total length of the segments
+ * must not exceed the IPC buffer length of the kernel.
+ * @param socket the socket to send on.
+ * @param iov array of segments that make up the message.
+ * @param count number of segments, at most `MORDAX_SOCKET_MAX_IOV`.
+ * @param flags socket flags; if `MORDAX_SOCKET_NONBLOCK` is set, the call
+ *              fails with `-EWOULDBLOCK` instead of blocking.
+ * @return the number of bytes sent or a negative error number.
+ */
+int mordax_socket_sendv(mordax_resource_t socket, const struct mordax_iovec * iov,
+	unsigned int count, unsigned int flags);
+
+/**
+ * Receives a message from a socket into several segments. The segments are
+ * filled in order, and the message is truncated if it is longer than the
+ * total length of the segments.
+ * @param socket the socket to receive from.
+ * @param iov array of segments to store the message into.
+ * @param count number of segments, at most `MORDAX_SOCKET_MAX_IOV`.
+ * @param flags socket flags; if `MORDAX_SOCKET_NONBLOCK` is set, the call
+ *              fails with `-EWOULDBLOCK` instead of blocking.
+ * @return the number of bytes received or a negative error number.
+ */
+int mordax_socket_receivev(mordax_resource_t socket, const struct mordax_iovec * iov,
+	unsigned int count, unsigned int flags);
+
+/**
+ * Sets the depth of the message queue of a socket. Messages sent to a socket
+ * with a message queue are copied into the queue if no thread is receiving,
+ * so that bursts of messages can be sent without waiting for the receiver.
+ * @param socket the socket.
+ * @param depth maximum number of queued messages, at most
+ *              `MORDAX_SOCKET_MAX_QUEUE_DEPTH`. A depth of 0, the default,
+ *              disables queueing.
+ * @return 0 if successful or a negative error number.
+ */
+int mordax_socket_set_queue_depth(mordax_resource_t socket, unsigned int depth);
+
 /**
  * Waits for a message on a socket.
  * @param socket the socket to wait on.
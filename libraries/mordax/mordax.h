@@ -5,11 +5,20 @@
 #ifndef __MORDAX_H__
 #define __MORDAX_H__
 
+#include <mordax/batch.h>
+#include <mordax/info.h>
+#include <mordax/lock.h>
+#include <mordax/log.h>
 #include <mordax/memory.h>
+#include <mordax/pmu.h>
 #include <mordax/process.h>
+#include <mordax/profile.h>
+#include <mordax/syscall_statistics.h>
 #include <mordax/system.h>
 #include <mordax/thread.h>
+#include <mordax/trace.h>
 #include <mordax/types.h>
+#include <mordax/waitset.h>
 
 /**
  * System administration system call.
@@ -46,6 +55,12 @@ int mordax_thread_join(tid_t tid);
  */
 void mordax_thread_yield(void);
 
+/**
+ * Blocks the calling thread for a period of time.
+ * @param microseconds the minimum time to sleep, in microseconds.
+ */
+void mordax_thread_sleep(uint32_t microseconds);
+
 /**
  * Gets information about the current thread/process.
  * @param function specifies which information to return. The valid constants
@@ -54,6 +69,125 @@ void mordax_thread_yield(void);
  */
 void * mordax_thread_info(int function);
 
+/**
+ * Gets the TID of the calling thread without doing a system call.
+ * @return the TID of the calling thread.
+ */
+tid_t mordax_thread_id(void);
+
+/**
+ * Gets the information page of the calling process. The page contains,
+ * among other things, the PID of the process and a monotonic clock, and can
+ * be read without doing any system calls. Only the first call does a system
+ * call, to look up the address of the page.
+ * @return a pointer to the read-only information page.
+ */
+const struct mordax_info_page * mordax_info_page(void);
+
+/**
+ * Gets scheduler statistics for all threads in the system, such as the
+ * processor time used by each thread and how often it has been preempted.
+ * @param buffer array to store the statistics in.
+ * @param length number of entries in the array.
+ * @return the number of threads found, or a negative error code if
+ *         an error occurs. If the return value is larger than `length`, only
+ *         the first `length` entries are filled in.
+ */
+int mordax_thread_statistics(struct mordax_thread_statistics * buffer, unsigned int length);
+
+/**
+ * Makes a thread a real-time thread. A real-time thread may use `budget`
+ * microseconds of processor time in every `period`, and is scheduled before
+ * all best-effort threads, earliest deadline first. The calling process must
+ * have the real-time permission.
+ * @param tid the TID of a thread in the calling process.
+ * @param budget processor time the thread may use in each period, in
+ *               microseconds. If this is 0, the thread becomes a best-effort
+ *               thread.
+ * @param period length of the period, in microseconds.
+ * @return 0 if successful, `-EBUSY` if there is not enough unreserved
+ *         processor time for the thread, or another negative error code
+ *         if an error occurs.
+ */
+int mordax_thread_set_realtime(tid_t tid, uint32_t budget, uint32_t period);
+
+/**
+ * Configures and reads the performance counters of the calling thread. The
+ * counters only count while the thread is running. If a configuration is
+ * given, all counters are reset and counting starts with the new events;
+ * the counters are then read into the counter buffer, if one is given.
+ * @param config the new counter configuration, or 0 to keep counting.
+ * @param counters buffer to store the counter values in, or 0.
+ * @return the number of event counters available, `-ENOENT` if counters are
+ *         read before being configured, or another negative error code if
+ *         an error occurs.
+ */
+int mordax_thread_pmu(const struct mordax_pmu_config * config, struct mordax_pmu_counters * counters);
+
+/**
+ * Reads messages from the kernel log. The calling process must have the
+ * log permission.
+ * @param position pointer to the position in the log to start reading from,
+ *                 which is updated to the position following the last byte
+ *                 read. Use 0 to start reading at the oldest message still
+ *                 in the log. If the position has been overwritten, reading
+ *                 starts at the oldest byte in the log.
+ * @param buffer buffer to read the messages into.
+ * @param length length of the buffer.
+ * @return the number of bytes read, 0 if there are no new messages, or a
+ *         negative error code if an error occurs.
+ */
+int mordax_log_read(uint32_t * position, char * buffer, size_t length);
+
+/**
+ * Maps the trace buffer of a processor read-only into the calling process.
+ * The buffer is a `struct mordax_trace_buffer` which the kernel keeps
+ * recording events into. The calling process must have the trace permission.
+ * @param cpu index of the processor.
+ * @param target page aligned address to map the buffer at. No memory may
+ *               already be mapped in the range the buffer is mapped into.
+ * @return the size of the mapping, or a negative error code if an error occurs.
+ */
+int mordax_trace_map(unsigned int cpu, void * target);
+
+/**
+ * Starts or stops the sampling profiler. A sample of the running thread is
+ * recorded on each processor every time the specified performance counter
+ * event has occured `period` times. The calling process must have the
+ * profile permission.
+ * @param event the event number to count, such as
+ *              `MORDAX_PMU_EVENT_INSTRUCTIONS`, or 0xff to count processor
+ *              cycles on the Cortex-A8.
+ * @param period number of events between each sample, at least
+ *               `MORDAX_PROFILE_MIN_PERIOD`, or 0 to stop sampling.
+ * @return 0 if successful, `-ENOSYS` if the kernel has no sampling profiler,
+ *         `-EINVAL` if the event or period is invalid, or another negative error code if an error occurs.
+ */
+int mordax_profile_start(uint32_t event, uint32_t period);
+
+/**
+ * Removes the oldest samples from the sample buffer of the sampling profiler.
+ * The calling process must have the profile permission.
+ * @param buffer array to store the samples in.
+ * @param length number of entries in the array.
+ * @param dropped pointer to a variable where the number of samples that were
+ *                dropped because the sample buffer was full is stored.
+ * @return the number of samples copied, or a negative error code if an
+ *         error occurs.
+ */
+int mordax_profile_read(struct mordax_profile_sample * buffer, size_t length, uint32_t * dropped);
+
+/**
+ * Gets contention statistics for the most contended locks in the system,
+ * sorted by the number of acquisitions that had to wait and then by the
+ * total time spent waiting.
+ * @param buffer array to store the statistics in.
+ * @param length number of entries in the array.
+ * @return the number of entries filled in, or a negative error code if an
+ *         error occurs.
+ */
+int mordax_lock_statistics(struct mordax_lock_statistics * buffer, unsigned int length);
+
 /**
  * Creates a new process. The process must have the required
  * permissions for this call to succeed.
@@ -89,7 +223,8 @@ void * mordax_memory_map(void * target, physical_ptr source, size_t size,
 
 /**
  * Allocates a chunk of physical memory and maps it into a process' virtual memory space.
- * The memory is freed by unmapping it.
+ * The memory is freed by unmapping it. No memory may already be mapped in
+ * the area the memory is mapped into.
  * @param target target address of the mapping.
  * @param size pointer to a `size_t` variable holding the size of the memory to allocate.
  *             This variable is updated with the actual size allocated.
@@ -103,7 +238,8 @@ void * mordax_memory_map_alloc(void * target, size_t * size,
 /**
  * Unmaps a virtual address from the process' virtual memory space.
  * If the memory that the virtual address refers to has previously been
- * allocated by the physical memory manager, it is freed.
+ * allocated by the physical memory manager, it is freed. Areas containing
+ * the information page are not unmapped.
  * @param virtual the virtual address to unmap.
  * @param size size of the address area to unmap.
  */
@@ -144,11 +280,61 @@ mordax_resource_t mordax_irq_create(unsigned irq);
  */
 int mordax_irq_listen(mordax_resource_t irq);
 
+/**
+ * Creates a wait set resource, which is used to wait for several resources
+ * at the same time.
+ * @return the identifier of the wait set or a negative error code.
+ */
+mordax_resource_t mordax_waitset_create(void);
+
+/**
+ * Adds a resource to a wait set. Sockets, services, locks and IRQ resources
+ * can be added to a wait set, and each resource can only be part of one wait
+ * set at a time. An IRQ resource is enabled when it is added, and is disabled
+ * each time the IRQ occurs until the next call to `mordax_waitset_wait`.
+ * @param waitset the wait set.
+ * @param resource the resource to add.
+ * @return 0 if successful, otherwise a negative error code.
+ */
+int mordax_waitset_add(mordax_resource_t waitset, mordax_resource_t resource);
+
+/**
+ * Removes a resource from a wait set.
+ * @param waitset the wait set.
+ * @param resource the resource to remove.
+ * @return 0 if successful, otherwise a negative error code.
+ */
+int mordax_waitset_remove(mordax_resource_t waitset, mordax_resource_t resource);
+
+/**
+ * Waits until one or more resources in a wait set are ready. Events are
+ * edge-triggered, so a resource is only reported again after a new event
+ * has occured on it.
+ * @param waitset the wait set to wait on.
+ * @param events array to store the events into.
+ * @param length length of the event array.
+ * @return the number of events stored in the array, otherwise a negative
+ *         error code.
+ */
+int mordax_waitset_wait(mordax_resource_t waitset, struct mordax_waitset_event * events,
+	unsigned int length);
+
 /**
  * Frees a resource.
  * @param identifier the resource identifier.
  */
 void mordax_resource_destroy(mordax_resource_t identifier);
 
+/**
+ * Executes a batch of system calls using a single kernel entry. Only system
+ * calls that do not block can be part of a batch; the return value of other
+ * system calls is set to `-ENOSYS`.
+ * @param entries array of system calls to execute. The return value of each
+ *                system call is stored in its entry.
+ * @param count number of entries in the array.
+ * @return 0 if successful, otherwise a negative error code.
+ */
+int mordax_syscall_batch(struct mordax_batch_entry * entries, unsigned int count);
+
 #endif
 
@@ -0,0 +1,294 @@
+// The Mordax Microkernel OS Tools
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+// Converts samples from the kernel sampling profiler into the folded stack
+// format used by flamegraph.pl. The samples are symbolized using the same
+// application files as are given to mkinitproc, which are assigned PIDs in
+// the order the loader creates the processes.
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <gelf.h>
+
+#include <sys/types.h>
+#include <sys/fcntl.h>
+
+#include "api/profile.h"
+
+// PID of the first application; the idle process and the loader come first:
+#define DEFAULT_FIRST_PID	2
+
+// Maximum length of a folded stack:
+#define MAX_STACK_LENGTH	2048
+
+struct symbol
+{
+	uint32_t address, size;
+	char * name;
+};
+
+struct application
+{
+	char * name;
+	struct symbol * symbols;
+	size_t num_symbols;
+};
+
+static bool load_application(struct application * app, const char * filename);
+static int compare_symbols(const void * a, const void * b);
+static int compare_strings(const void * a, const void * b);
+static const struct symbol * find_symbol(const struct application * app, uint32_t address);
+static char * fold_sample(const struct mordax_profile_sample * sample, struct application * apps,
+	int num_apps, int first_pid);
+static void append_frame(char * stack, const char ** previous, const char * frame);
+
+int main(int argc, char * argv[])
+{
+	int first_pid = DEFAULT_FIRST_PID;
+	int option;
+
+	while((option = getopt(argc, argv, "p:h")) != -1)
+	{
+		switch(option)
+		{
+			case 'p':
+				first_pid = atoi(optarg);
+				break;
+			case 'h':
+			default:
+				printf("profconv [-p first application PID] [sample file] [application files (in ELF format)...] > profile.folded\n");
+				return option == 'h' ? 0 : 1;
+		}
+	}
+
+	if(optind >= argc)
+	{
+		printf("profconv [-p first application PID] [sample file] [application files (in ELF format)...] > profile.folded\n");
+		return 1;
+	}
+
+	if(elf_version(EV_CURRENT) == EV_NONE)
+	{
+		fprintf(stderr, "Error: cannot initialize libelf: %s\n", elf_errmsg(-1));
+		return 1;
+	}
+
+	int num_apps = argc - optind - 1;
+	struct application * apps = calloc(num_apps > 0 ? num_apps : 1, sizeof(struct application));
+	for(int i = 0; i < num_apps; ++i)
+	{
+		if(!load_application(&apps[i], argv[optind + 1 + i]))
+			return 1;
+	}
+
+	FILE * input = fopen(argv[optind], "rb");
+	if(input == NULL)
+	{
+		int error = errno;
+		fprintf(stderr, "Error: cannot open %s: %s\n", argv[optind], strerror(error));
+		return 1;
+	}
+
+	// Fold every sample into a stack string, then sort the strings so that
+	// equal stacks can be counted:
+	size_t num_stacks = 0, stacks_size = 1024;
+	char ** stacks = malloc(stacks_size * sizeof(char *));
+
+	struct mordax_profile_sample sample;
+	while(fread(&sample, sizeof(struct mordax_profile_sample), 1, input) == 1)
+	{
+		if(num_stacks == stacks_size)
+		{
+			stacks_size *= 2;
+			stacks = realloc(stacks, stacks_size * sizeof(char *));
+		}
+		stacks[num_stacks++] = fold_sample(&sample, apps, num_apps, first_pid);
+	}
+	fclose(input);
+
+	qsort(stacks, num_stacks, sizeof(char *), compare_strings);
+	for(size_t i = 0; i < num_stacks;)
+	{
+		size_t count = 1;
+		while(i + count < num_stacks && !strcmp(stacks[i], stacks[i + count]))
+			++count;
+
+		printf("%s %zu\n", stacks[i], count);
+		i += count;
+	}
+
+	fprintf(stderr, "%zu samples converted\n", num_stacks);
+	return 0;
+}
+
+static bool load_application(struct application * app, const char * filename)
+{
+	int input_file = open(filename, O_RDONLY);
+	if(input_file == -1)
+	{
+		int error = errno;
+		fprintf(stderr, "Error: cannot open input file %s: %s\n", filename, strerror(error));
+		return false;
+	}
+
+	Elf * input_elf = elf_begin(input_file, ELF_C_READ, NULL);
+	if(input_elf == NULL || elf_kind(input_elf) != ELF_K_ELF)
+	{
+		fprintf(stderr, "Error: input file %s is not an ELF object\n", filename);
+		close(input_file);
+		return false;
+	}
+
+	char * basename_temp = strdup(filename);
+	app->name = strdup(basename(basename_temp));
+	free(basename_temp);
+
+	size_t symbols_size = 0;
+	Elf_Scn * section = NULL;
+	while((section = elf_nextscn(input_elf, section)) != NULL)
+	{
+		GElf_Shdr section_header;
+		gelf_getshdr(section, &section_header);
+		if(section_header.sh_type != SHT_SYMTAB)
+			continue;
+
+		Elf_Data * data = elf_getdata(section, NULL);
+		size_t count = section_header.sh_size / section_header.sh_entsize;
+		for(size_t i = 0; i < count; ++i)
+		{
+			GElf_Sym symbol;
+			gelf_getsym(data, i, &symbol);
+			if(GELF_ST_TYPE(symbol.st_info) != STT_FUNC || symbol.st_value == 0)
+				continue;
+
+			if(app->num_symbols == symbols_size)
+			{
+				symbols_size = symbols_size == 0 ? 256 : symbols_size * 2;
+				app->symbols = realloc(app->symbols, symbols_size * sizeof(struct symbol));
+			}
+
+			// The lowest bit is set for Thumb functions:
+			struct symbol * entry = &app->symbols[app->num_symbols++];
+			entry->address = symbol.st_value & ~1;
+			entry->size = symbol.st_size;
+			entry->name = strdup(elf_strptr(input_elf, section_header.sh_link, symbol.st_name));
+		}
+	}
+
+	elf_end(input_elf);
+	close(input_file);
+
+	if(app->num_symbols == 0)
+		fprintf(stderr, "Warning: %s has no function symbols\n", filename);
+	qsort(app->symbols, app->num_symbols, sizeof(struct symbol), compare_symbols);
+	return true;
+}
+
+static int compare_symbols(const void * a, const void * b)
+{
+	const struct symbol * sa = a, * sb = b;
+	return sa->address < sb->address ? -1 : sa->address > sb->address;
+}
+
+static int compare_strings(const void * a, const void * b)
+{
+	return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+static const struct symbol * find_symbol(const struct application * app, uint32_t address)
+{
+	// Find the last symbol starting at or before the address:
+	size_t low = 0, high = app->num_symbols;
+	while(low < high)
+	{
+		size_t middle = (low + high) / 2;
+		if(app->symbols[middle].address <= address)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	if(low == 0)
+		return NULL;
+
+	const struct symbol * retval = &app->symbols[low - 1];
+	if(retval->size != 0 && address >= retval->address + retval->size)
+		return NULL;
+	return retval;
+}
+
+static char * fold_sample(const struct mordax_profile_sample * sample, struct application * apps,
+	int num_apps, int first_pid)
+{
+	char stack[MAX_STACK_LENGTH], frame[32];
+	const char * previous = NULL;
+
+	int app_index = sample->pid - first_pid;
+	struct application * app = app_index >= 0 && app_index < num_apps ? &apps[app_index] : NULL;
+
+	if(app != NULL)
+		snprintf(stack, sizeof(stack), "%s", app->name);
+	else if(sample->pid == 0)
+		snprintf(stack, sizeof(stack), "idle");
+	else
+		snprintf(stack, sizeof(stack), "pid %u", sample->pid);
+
+	if(sample->flags & MORDAX_PROFILE_SAMPLE_KERNEL)
+	{
+		append_frame(stack, &previous, "[kernel]");
+		return strdup(stack);
+	}
+
+	if(app != NULL)
+	{
+		// The threads do not keep frame pointers, so the stack is scanned for
+		// words that look like return addresses instead, starting with the
+		// oldest. A return address points after the call instruction, so the
+		// address before it is looked up. Stale return addresses left on the
+		// stack can show up as extra callers:
+		for(int i = sample->stack_words; i > 0; --i)
+		{
+			uint32_t address = sample->stack[i - 1];
+			if(!(address & 1) && (address & 3))
+				continue;
+
+			const struct symbol * symbol = find_symbol(app, (address & ~1) - 1);
+			if(symbol != NULL)
+				append_frame(stack, &previous, symbol->name);
+		}
+
+		// The link register holds the return address of leaf functions:
+		const struct symbol * symbol = find_symbol(app, (sample->lr & ~1) - 1);
+		if(symbol != NULL)
+			append_frame(stack, &previous, symbol->name);
+	}
+
+	const struct symbol * symbol = app != NULL ? find_symbol(app, sample->pc) : NULL;
+	if(symbol != NULL)
+		append_frame(stack, &previous, symbol->name);
+	else {
+		snprintf(frame, sizeof(frame), "0x%08x", sample->pc);
+		append_frame(stack, &previous, frame);
+	}
+
+	return strdup(stack);
+}
+
+static void append_frame(char * stack, const char ** previous, const char * frame)
+{
+	// Recursion and return addresses found more than once are shown as one frame:
+	if(*previous != NULL && !strcmp(*previous, frame))
+		return;
+	*previous = frame;
+
+	size_t length = strlen(stack);
+	snprintf(stack + length, MAX_STACK_LENGTH - length, ";%s", frame);
+}
+
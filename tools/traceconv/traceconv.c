@@ -0,0 +1,273 @@
+// The Mordax Microkernel OS Tools
+// (c) Kristian Klomsten Skordal 2014 <kristian.skordal@gmail.com>
+// Report bugs and issues on <http://github.com/skordal/mordax/issues>
+
+// Converts copies of the kernel trace buffers into the JSON trace event
+// format, which can be opened in chrome://tracing and in Perfetto.
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "api/trace.h"
+
+// PID used for the interrupt lanes, one lane for each processor:
+#define INTERRUPTS_PID	0
+
+// State of a processor while converting its trace buffer:
+struct cpu_state
+{
+	uint32_t cpu;
+	double cycles_per_us;
+	uint64_t clock_cycles, clock_time;
+
+	bool running;			// Whether a thread has been switched to.
+	uint16_t pid;			// PID of the running thread.
+	uint32_t tid;			// TID of the running thread.
+	double running_since;
+
+	bool in_syscall;
+	uint16_t syscall;
+	double syscall_start;
+
+	bool in_irq;
+	uint16_t irq;
+	double irq_start;
+};
+
+static bool convert_buffer(FILE * output, const char * filename, double default_mhz);
+static double event_time(const struct cpu_state * state, uint64_t timestamp);
+static void convert_event(FILE * output, struct cpu_state * state, const struct mordax_trace_event * event);
+static void end_running(FILE * output, struct cpu_state * state, double time);
+static void end_syscall(FILE * output, struct cpu_state * state, double time, const char * result);
+static void write_event(FILE * output, const char * format, ...) __attribute((format(printf, 2, 3)));
+
+static bool first_event = true;
+
+int main(int argc, char * argv[])
+{
+	double default_mhz = 0.0;
+	int option;
+
+	while((option = getopt(argc, argv, "f:h")) != -1)
+	{
+		switch(option)
+		{
+			case 'f':
+				default_mhz = strtod(optarg, NULL);
+				break;
+			case 'h':
+			default:
+				printf("traceconv [-f processor MHz] [trace buffer files...] > trace.json\n");
+				return option == 'h' ? 0 : 1;
+		}
+	}
+
+	if(optind >= argc)
+	{
+		printf("traceconv [-f processor MHz] [trace buffer files...] > trace.json\n");
+		return 1;
+	}
+
+	fprintf(stdout, "{\"traceEvents\":[\n");
+	write_event(stdout, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Interrupts\"}}",
+		INTERRUPTS_PID);
+
+	int retval = 0;
+	for(int i = optind; i < argc; ++i)
+	{
+		if(!convert_buffer(stdout, argv[i], default_mhz))
+			retval = 1;
+	}
+
+	fprintf(stdout, "\n],\"displayTimeUnit\":\"ns\"}\n");
+	return retval;
+}
+
+static bool convert_buffer(FILE * output, const char * filename, double default_mhz)
+{
+	FILE * input = fopen(filename, "rb");
+	if(input == NULL)
+	{
+		int error = errno;
+		fprintf(stderr, "Error: cannot open %s: %s\n", filename, strerror(error));
+		return false;
+	}
+
+	struct mordax_trace_buffer header;
+	if(fread(&header, sizeof(struct mordax_trace_buffer), 1, input) != 1)
+	{
+		fprintf(stderr, "Error: %s is too short to be a trace buffer\n", filename);
+		fclose(input);
+		return false;
+	}
+
+	if(header.version != MORDAX_TRACE_VERSION || header.length == 0)
+	{
+		fprintf(stderr, "Error: %s is not a trace buffer of a supported version\n", filename);
+		fclose(input);
+		return false;
+	}
+
+	struct mordax_trace_event * events = malloc(header.length * sizeof(struct mordax_trace_event));
+	if(fread(events, sizeof(struct mordax_trace_event), header.length, input) != header.length)
+	{
+		fprintf(stderr, "Error: %s does not contain %u events\n", filename, header.length);
+		free(events);
+		fclose(input);
+		return false;
+	}
+	fclose(input);
+
+	struct cpu_state state;
+	memset(&state, 0, sizeof(struct cpu_state));
+	state.cpu = header.cpu;
+	state.clock_cycles = header.clock_cycles;
+	state.clock_time = header.clock_time;
+
+	// The clock fields give the processor frequency, unless the scheduler
+	// had not been started when the buffer was copied:
+	if(header.clock_time > 0)
+		state.cycles_per_us = (double) header.clock_cycles / (double) header.clock_time;
+	else
+		state.cycles_per_us = default_mhz;
+	if(state.cycles_per_us <= 0.0)
+	{
+		fprintf(stderr, "Error: the processor frequency for %s is not known, specify it using -f\n",
+			filename);
+		free(events);
+		return false;
+	}
+
+	write_event(output, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"CPU %u\"}}",
+		INTERRUPTS_PID, header.cpu, header.cpu);
+
+	// The oldest event may have been overwritten while the buffer was copied,
+	// so it is only used if the ring has not wrapped around:
+	uint32_t first = header.head >= header.length ? header.head - header.length + 1 : 0;
+	double last_time = 0.0;
+	for(uint32_t n = first; n != header.head; ++n)
+	{
+		const struct mordax_trace_event * event = &events[n % header.length];
+		convert_event(output, &state, event);
+		last_time = event_time(&state, event->timestamp);
+	}
+
+	// Close the slices that are still open at the end of the trace:
+	if(state.in_irq)
+		write_event(output, "{\"name\":\"IRQ %u\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			state.irq, INTERRUPTS_PID, state.cpu, state.irq_start, last_time - state.irq_start);
+	end_running(output, &state, last_time);
+
+	free(events);
+	return true;
+}
+
+static double event_time(const struct cpu_state * state, uint64_t timestamp)
+{
+	// Timestamps are converted relative to the clock fields, so that the
+	// events of all processors use the scheduler clock:
+	return (double) state->clock_time
+		+ ((double) timestamp - (double) state->clock_cycles) / state->cycles_per_us;
+}
+
+static void convert_event(FILE * output, struct cpu_state * state, const struct mordax_trace_event * event)
+{
+	double time = event_time(state, event->timestamp);
+
+	switch(event->type)
+	{
+		case MORDAX_TRACE_SWITCH:
+			end_running(output, state, time);
+			state->running = true;
+			state->pid = event->data;
+			state->tid = event->argument;
+			state->running_since = time;
+			break;
+		case MORDAX_TRACE_SYSCALL_ENTRY:
+			if(state->running)
+			{
+				state->in_syscall = true;
+				state->syscall = event->data;
+				state->syscall_start = time;
+			}
+			break;
+		case MORDAX_TRACE_SYSCALL_EXIT:
+			if(state->in_syscall)
+			{
+				char result[16];
+				snprintf(result, sizeof(result), "%d", (int32_t) event->argument);
+				end_syscall(output, state, time, result);
+			}
+			break;
+		case MORDAX_TRACE_IRQ_ENTRY:
+			state->in_irq = true;
+			state->irq = event->data;
+			state->irq_start = time;
+			break;
+		case MORDAX_TRACE_IRQ_EXIT:
+			if(state->in_irq && state->irq == event->data)
+				write_event(output, "{\"name\":\"IRQ %u\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+					event->data, INTERRUPTS_PID, state->cpu, state->irq_start, time - state->irq_start);
+			state->in_irq = false;
+			break;
+		case MORDAX_TRACE_LOCK_BLOCK:
+			if(state->running)
+				write_event(output, "{\"name\":\"lock block\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"args\":{\"lock\":\"0x%08x\"}}",
+					state->pid, state->tid, time, event->argument);
+			break;
+		case MORDAX_TRACE_LOCK_WAKE:
+			write_event(output, "{\"name\":\"lock wake\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f}",
+				event->data, event->argument, time);
+			break;
+		case MORDAX_TRACE_PAGE_FAULT:
+			if(state->running)
+				write_event(output, "{\"name\":\"page fault\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"args\":{\"address\":\"0x%08x\",\"access\":\"%s\"}}",
+					state->pid, state->tid, time, event->argument, event->data ? "write" : "read");
+			break;
+		default:
+			fprintf(stderr, "Warning: skipping event of unknown type %u\n", event->type);
+			break;
+	}
+}
+
+static void end_running(FILE * output, struct cpu_state * state, double time)
+{
+	if(!state->running)
+		return;
+
+	// A system call that is still running when another thread is switched
+	// to has blocked the calling thread:
+	if(state->in_syscall)
+		end_syscall(output, state, time, "blocked");
+
+	write_event(output, "{\"name\":\"running\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"cpu\":%u}}",
+		state->pid, state->tid, state->running_since, time - state->running_since, state->cpu);
+	state->running = false;
+}
+
+static void end_syscall(FILE * output, struct cpu_state * state, double time, const char * result)
+{
+	write_event(output, "{\"name\":\"syscall %u\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"result\":\"%s\"}}",
+		state->syscall, state->pid, state->tid, state->syscall_start, time - state->syscall_start, result);
+	state->in_syscall = false;
+}
+
+static void write_event(FILE * output, const char * format, ...)
+{
+	va_list arguments;
+	va_start(arguments, format);
+
+	if(!first_event)
+		fprintf(output, ",\n");
+	vfprintf(output, format, arguments);
+	first_event = false;
+
+	va_end(arguments);
+}
+